@@ -1,4 +1,4 @@
-// VERSION 104
+// VERSION 105
 
 /*
     FPToolkit.c : A simple set of graphical tools.
@@ -81,6 +81,138 @@ an int if the function was declared to do so
 */
 
 
+/* Version 105 :
+  G_project_points (x,y,z, m, viewport, hither, xpoints, n)
+  transforms, perspective divides and maps model points to
+  y-flipped XPoints in one pass, and
+  G_fill_polygon_xpoints / G_polygon_xpoints
+  hand such XPoints straight to the rasterizer.
+*/
+
+
+/* Version 106 :
+  G_init_graphics_memory (w,h)
+  selects a headless backend that draws into a frame buffer
+  in main memory; no X server is needed.  Its lines are
+  Bresenham runs written straight into the buffer.
+  Safe_Line_X now clips in a single Liang-Barsky pass
+  (Clip_Line_Liang_Barsky) shared with the memory backend.
+*/
+
+
+/* Version 107 :
+  G_fill_triangle_rgb (x[3], y[3], rgb[3][3])
+  fills a triangle with a color given at each vertex.
+  The memory backend interpolates them (Gouraud) with an
+  edge function rasterizer that has 1/16 pixel precision,
+  the top-left fill rule and 4x4 SSE2 blocks ; it also does
+  the flat G_fill_triangle.  On X the triangle is filled
+  flat with the average of the three colors.
+*/
+
+
+/* Version 108 :
+  G_fill_triangle_3d and G_fill_polygon_3d take a depth at
+  each vertex and draw only the pixels nearer than what is
+  already there.  The depth buffer is allocated with the
+  memory frame buffer, or on the first such fill on X, and
+  cleared by G_clear ; it keeps a depth bound per 8x8 tile,
+  so clearing touches only the tiles and hidden triangles
+  skip whole tiles.  X tests on the client and sends the
+  pixels that pass as batched rectangles.
+*/
+
+
+/* Version 109 :
+  G_antialias (1) turns on antialiasing in the memory
+  backend : Wu lines and circles, filled circles blended by
+  distance, and polygon, triangle and rectangle fills with
+  exact per-pixel area coverage, blended 4 pixels at a time
+  with SSE2.  X keeps drawing plain pixels.
+*/
+
+
+/* Version 110 :
+  G_rgba (r,g,b,a) and Gi_rgba (r,g,b,a) add an opacity to
+  the current color.  The memory backend mixes everything it
+  draws into the buffer (source over), whole spans at a time
+  with SSE2 ; G_rgb and Gi_rgb go back to opaque.  X ignores
+  the opacity.
+*/
+
+
+/* Version 111 :
+  G_change_pen_dimensions (w,h) sets the width of lines,
+  polylines, polygons, rectangles and circles, and
+  G_pen_join (G_JOIN_MITER, G_JOIN_ROUND or G_JOIN_BEVEL)
+  how wide lines meet.  X uses the GC line attributes.  The
+  memory backend turns a whole wide path into one nonzero
+  fill, so each pixel is painted once.  G_polyline (x,y,n)
+  draws an open path with joins at its inner points.
+*/
+
+
+/* Version 112 :
+  G_sector and G_fill_sector place their arc points by
+  rotating the first one, with as many as keep the chords
+  within 1/4 pixel of the circle instead of 500 per turn.
+  G_fill_sector is now per backend : X sends one XFillArc,
+  the memory backend fills the rows of the pie directly.
+*/
+
+
+/* Version 113 :
+  Circle outlines go out as batched XDrawPoints requests (or
+  straight into the memory buffer), each octant checked
+  against the window once rather than each point.
+  G_ellipse (x,y,rx,ry) and G_fill_ellipse (x,y,rx,ry) draw
+  midpoint ellipses, batched into XFillRectangles spans.
+*/
+
+
+/* Version 114 :
+  p = G_prepare_polygon (x,y,n) scans a polygon once into
+  rectangles of pixels ; G_fill_prepared_polygon (p,dx,dy)
+  then fills it moved by (dx,dy) as spans in memory, with
+  nothing to tessellate.  X sends the vertices, kept as
+  steps from one to the next, as one XFillPolygon request
+  in which only the first point moves ; the rectangles are
+  the fallback.  G_free_prepared_polygon (p) frees it.
+*/
+
+
+/* Version 115 :
+  G_set_clip_rect (x,y,w,h) limits all drawing, G_clear
+  included, to a rectangle of the window until G_clear_clip ().
+  X clips in the server (XSetClipRectangles) ; both backends
+  also skip any primitive whose bounding box misses it.
+*/
+
+
+/* Version 116 :
+  A built in font with the metrics of 10x20, kept as glyph
+  rectangles, draws the text of the memory backend and of X
+  when the 10x20 font cannot be loaded.
+  G_draw_strings (n, strings, x, y) draws many strings at once,
+  as few XFillRectangles requests as the glyphs need.
+*/
+
+
+/* Version 117 :
+  G_draw_text draws lines of text in the built in font scaled to
+  any height and width ; the glyphs of each size are scaled once
+  and kept, for the last TEXT_CACHE_SIZES sizes used.
+*/
+
+
+/* Version 118 :
+  G_string_pixel_width adds up a table of the widths of the
+  font's characters, made once per font, instead of asking
+  XTextWidth each time.  G_string_pixel_widths (n, strings,
+  widths) measures many strings in one call.
+*/
+
+
 					    
 
 #ifndef FPT876PBNM3521
@@ -94,6 +226,10 @@ an int if the function was declared to do so
 #include <time.h> // for the get_time stuff
 #include <sys/time.h> 
 #include <string.h> // for strlen
+#include <limits.h> // INT_MAX
+#ifdef __SSE2__
+#include <emmintrin.h> // memory backend rasterizer
+#endif
 
 
 
@@ -109,6 +245,7 @@ an int if the function was declared to do so
 #include <X11/Xutil.h>// for XComposeStatus
 
 int Set_Color_Rgb_X (int r, int g, int b) ;
+int Set_Color_Rgb_DX (double dr, double dg, double db) ;
 
 
 typedef XImage *XImagePointer ;
@@ -134,12 +271,430 @@ static GC XxTmpContext;
 static char XxFont[100] = "10x20" ;  
 
 static XFontStruct *XxFontInfo;
+static XFontStruct *Xx_Advance_Font ; // the font Xx_Advance was made for
+static int Xx_Advance[256] ;          // its width of each byte
+static int Xx_Advance_Fixed ;         // or the one width of them all, or -1
+static int Xx_Advance_Ok ;            // 0 if XTextWidth must measure it
 static int Current_Red_Int ;
 static int Current_Green_Int ;
 static int Current_Blue_Int ;
+static int Current_Alpha_Int = 255 ; // 255 is opaque ; only the memory backend blends
+static int Current_Alpha_Weight = 256 ; // the same out of 256, as the mixing uses it
 static unsigned long int Current_Color_Pixel ;
 static unsigned long int Last_Clear_Buffer_Pixel ;
 
+#define G_JOIN_MITER  JoinMiter // how wide lines meet, for G_pen_join
+#define G_JOIN_ROUND  JoinRound
+#define G_JOIN_BEVEL  JoinBevel
+
+static double Current_Pen_Width = 1 ; // 1 or less is the thin pen
+static int Current_Pen_Join = G_JOIN_MITER ;
+
+typedef struct {
+  int n ;           // number of vertices
+  double *x, *y ;   // the vertices, for the antialiased memory fill
+  int nrect ;       // number of rectangles
+  int *rect ;       // 4 ints each : x, top, width, height
+  int x0, x1 ;      // range of the rectangles in x
+  int top0, top1 ;  // and in rows
+  XPoint *xp ;      // the rounded vertices for X : the first one, then each
+                    // less the one before (CoordModePrevious), or NULL
+  int vx0, vx1 ;    // range of the rounded vertices in x
+  int vtop0, vtop1 ; // and in rows
+} G_Prepared_Polygon ;
+// The pixels of a filled polygon as rectangles, made by
+// G_prepare_polygon.  Rows count down from the top of the
+// window, so that row top is Xx_Pix_height - 1 + top.
+
+#define XX_BATCH 512 // points or rectangles per X request
+
+typedef struct {
+  XRectangle *rect ; // XX_BATCH of them
+  int n ;            // in use
+} Xx_Batch ;         // rectangles passed through a callback
+
+// the depth buffer of the memory backend, which X uses too
+static void Mm_Clear_Depth () ;
+static void Mm_Free_Depth () ;
+static int Mm_Fill_Triangle_3d (double x[3], double row[3], double z[3], Xx_Batch *runs) ;
+
+static int Clip_On = 0 ; // G_set_clip_rect is in force
+static int Clip_c0, Clip_c1, Clip_r0, Clip_r1 ; // device columns and rows
+// that drawing may touch, inclusive : the whole window without a clip
+// rectangle, and c0 > c1 when nothing may be drawn
+
+
+
+static void Clip_Whole_Window ()
+{
+  Clip_On = 0 ;
+  Clip_c0 = 0 ; Clip_c1 = Xx_Pix_width - 1 ;
+  Clip_r0 = 0 ; Clip_r1 = Xx_Pix_height - 1 ;
+}
+
+
+
+static int Clip_Set_Rect (double Dx, double Dy, double Dw, double Dh)
+// the pixels of G_fill_rectangle (x,y,w,h) that are in the window
+// return 0 if there are none, else 1
+{
+  int x = (int)Dx ;
+  int y = (int)Dy ;
+  int w = (int)Dw ;
+  int h = (int)Dh ;
+
+  Clip_On = 1 ;
+  Clip_c0 = (x < 0) ? 0 : x ;
+  Clip_c1 = (x + w > Xx_Pix_width) ? Xx_Pix_width - 1 : x + w - 1 ;
+  Clip_r0 = (y + h > Xx_Pix_height) ? 0 : Xx_Pix_height - y - h ;
+  Clip_r1 = (y < 0) ? Xx_Pix_height - 1 : Xx_Pix_height - 1 - y ;
+  if ((w <= 0) || (h <= 0) || (Clip_c0 > Clip_c1) || (Clip_r0 > Clip_r1)) {
+    Clip_c0 = 0 ; Clip_c1 = -1 ;
+    Clip_r0 = 0 ; Clip_r1 = -1 ;
+    return 0 ;
+  }
+  return 1 ;
+}
+
+
+
+static int Clip_Out (int c0, int r0, int c1, int r1)
+// 1 if the device pixels c0..c1 x r0..r1 are all clipped away,
+// so that whatever lies within them can be skipped
+{
+  return (Clip_c0 > Clip_c1) || (c1 < Clip_c0) || (c0 > Clip_c1) ||
+         (r1 < Clip_r0) || (r0 > Clip_r1) ;
+}
+
+
+
+static int Clip_Pen_Margin ()
+// how far past its path a line with the current pen can reach :
+// half the width, or a miter of up to about 10 half widths
+{
+  if (Current_Pen_Width <= 1) return 0 ;
+  if (Current_Pen_Join == G_JOIN_MITER) return (int)ceil(6 * Current_Pen_Width) ;
+  return (int)ceil(Current_Pen_Width) ;
+}
+
+
+
+static int Clip_Out_XPoints (XPoint *p, int n, int m)
+// Clip_Out for the box of n device points, grown by m
+{
+  int k, c0, c1, r0, r1 ;
+
+  if (n <= 0) return 1 ;
+  c0 = c1 = p[0].x ; r0 = r1 = p[0].y ;
+  for (k = 1 ; k < n ; k++) {
+    if (p[k].x < c0) c0 = p[k].x ; else if (p[k].x > c1) c1 = p[k].x ;
+    if (p[k].y < r0) r0 = p[k].y ; else if (p[k].y > r1) r1 = p[k].y ;
+  }
+  return Clip_Out (c0 - m, r0 - m, c1 + m, r1 + m) ;
+}
+
+
+
+#define FONT_FIRST ' ' // the built in font, for when the X font
+#define FONT_LAST  '~' // cannot be loaded and for the memory backend
+#define FONT_WIDTH 10  // has the metrics of the 10x20 X font
+#define FONT_HEIGHT 20
+#define FONT_ASCENT 16
+#define FONT_GLYPHS (FONT_LAST - FONT_FIRST + 1)
+#define FONT_MAX_RECTS 32 // per glyph ; none needs more than 24
+
+static const unsigned char Font_Strokes[FONT_GLYPHS][9] = {
+// 5 columns (bit 4 is the left one) by 7 rows down to the
+// baseline and 2 below it ; Font_Build traces these with 1 pixel
+// strokes at twice the spacing, in the top left 9 x 17 of the cell
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // space
+  { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04, 0x00, 0x00 }, // !
+  { 0x0a, 0x0a, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // "
+  { 0x0a, 0x0a, 0x1f, 0x0a, 0x1f, 0x0a, 0x0a, 0x00, 0x00 }, // #
+  { 0x04, 0x0f, 0x14, 0x0e, 0x05, 0x1e, 0x04, 0x00, 0x00 }, // $
+  { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03, 0x00, 0x00 }, // %
+  { 0x0c, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0d, 0x00, 0x00 }, // &
+  { 0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '
+  { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02, 0x00, 0x00 }, // (
+  { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08, 0x00, 0x00 }, // )
+  { 0x00, 0x04, 0x15, 0x0e, 0x15, 0x04, 0x00, 0x00, 0x00 }, // *
+  { 0x00, 0x04, 0x04, 0x1f, 0x04, 0x04, 0x00, 0x00, 0x00 }, // +
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x04, 0x08, 0x00 }, // ,
+  { 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00 }, // -
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c, 0x00, 0x00 }, // .
+  { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00, 0x00 }, // /
+  { 0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e, 0x00, 0x00 }, // 0
+  { 0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00, 0x00 }, // 1
+  { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f, 0x00, 0x00 }, // 2
+  { 0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e, 0x00, 0x00 }, // 3
+  { 0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02, 0x00, 0x00 }, // 4
+  { 0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e, 0x00, 0x00 }, // 5
+  { 0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e, 0x00, 0x00 }, // 6
+  { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08, 0x00, 0x00 }, // 7
+  { 0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e, 0x00, 0x00 }, // 8
+  { 0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c, 0x00, 0x00 }, // 9
+  { 0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00, 0x00, 0x00 }, // :
+  { 0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x04, 0x08, 0x00, 0x00 }, // ;
+  { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02, 0x00, 0x00 }, // <
+  { 0x00, 0x00, 0x1f, 0x00, 0x1f, 0x00, 0x00, 0x00, 0x00 }, // =
+  { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08, 0x00, 0x00 }, // >
+  { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04, 0x00, 0x00 }, // ?
+  { 0x0e, 0x11, 0x01, 0x0d, 0x15, 0x15, 0x0e, 0x00, 0x00 }, // @
+  { 0x0e, 0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x00, 0x00 }, // A
+  { 0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e, 0x00, 0x00 }, // B
+  { 0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e, 0x00, 0x00 }, // C
+  { 0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c, 0x00, 0x00 }, // D
+  { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f, 0x00, 0x00 }, // E
+  { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10, 0x00, 0x00 }, // F
+  { 0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f, 0x00, 0x00 }, // G
+  { 0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11, 0x00, 0x00 }, // H
+  { 0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00, 0x00 }, // I
+  { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c, 0x00, 0x00 }, // J
+  { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11, 0x00, 0x00 }, // K
+  { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f, 0x00, 0x00 }, // L
+  { 0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11, 0x00, 0x00 }, // M
+  { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11, 0x00, 0x00 }, // N
+  { 0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x00, 0x00 }, // O
+  { 0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10, 0x00, 0x00 }, // P
+  { 0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d, 0x00, 0x00 }, // Q
+  { 0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11, 0x00, 0x00 }, // R
+  { 0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e, 0x00, 0x00 }, // S
+  { 0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00 }, // T
+  { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x00, 0x00 }, // U
+  { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04, 0x00, 0x00 }, // V
+  { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a, 0x00, 0x00 }, // W
+  { 0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11, 0x00, 0x00 }, // X
+  { 0x11, 0x11, 0x11, 0x0a, 0x04, 0x04, 0x04, 0x00, 0x00 }, // Y
+  { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f, 0x00, 0x00 }, // Z
+  { 0x0e, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0e, 0x00, 0x00 }, // [
+  { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00, 0x00 }, // backslash
+  { 0x0e, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0e, 0x00, 0x00 }, // ]
+  { 0x04, 0x0a, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ^
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x00 }, // _
+  { 0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // `
+  { 0x00, 0x00, 0x0e, 0x01, 0x0f, 0x11, 0x0f, 0x00, 0x00 }, // a
+  { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1e, 0x00, 0x00 }, // b
+  { 0x00, 0x00, 0x0e, 0x10, 0x10, 0x11, 0x0e, 0x00, 0x00 }, // c
+  { 0x01, 0x01, 0x0d, 0x13, 0x11, 0x11, 0x0f, 0x00, 0x00 }, // d
+  { 0x00, 0x00, 0x0e, 0x11, 0x1f, 0x10, 0x0e, 0x00, 0x00 }, // e
+  { 0x06, 0x09, 0x08, 0x1c, 0x08, 0x08, 0x08, 0x00, 0x00 }, // f
+  { 0x00, 0x00, 0x0f, 0x11, 0x11, 0x0f, 0x01, 0x11, 0x0e }, // g
+  { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00, 0x00 }, // h
+  { 0x04, 0x00, 0x0c, 0x04, 0x04, 0x04, 0x0e, 0x00, 0x00 }, // i
+  { 0x02, 0x00, 0x06, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c }, // j
+  { 0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12, 0x00, 0x00 }, // k
+  { 0x0c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00, 0x00 }, // l
+  { 0x00, 0x00, 0x1a, 0x15, 0x15, 0x15, 0x15, 0x00, 0x00 }, // m
+  { 0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00, 0x00 }, // n
+  { 0x00, 0x00, 0x0e, 0x11, 0x11, 0x11, 0x0e, 0x00, 0x00 }, // o
+  { 0x00, 0x00, 0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10 }, // p
+  { 0x00, 0x00, 0x0f, 0x11, 0x11, 0x0f, 0x01, 0x01, 0x01 }, // q
+  { 0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10, 0x00, 0x00 }, // r
+  { 0x00, 0x00, 0x0f, 0x10, 0x0e, 0x01, 0x1e, 0x00, 0x00 }, // s
+  { 0x08, 0x08, 0x1c, 0x08, 0x08, 0x09, 0x06, 0x00, 0x00 }, // t
+  { 0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0d, 0x00, 0x00 }, // u
+  { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0a, 0x04, 0x00, 0x00 }, // v
+  { 0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0a, 0x00, 0x00 }, // w
+  { 0x00, 0x00, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x00, 0x00 }, // x
+  { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0f, 0x01, 0x11, 0x0e }, // y
+  { 0x00, 0x00, 0x1f, 0x02, 0x04, 0x08, 0x1f, 0x00, 0x00 }, // z
+  { 0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02, 0x00, 0x00 }, // {
+  { 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00 }, // |
+  { 0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08, 0x00, 0x00 }, // }
+  { 0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00, 0x00, 0x00 }, // ~
+} ;
+
+static short Font_Rect[FONT_GLYPHS][FONT_MAX_RECTS][4] ; // x, top, width, height
+static int Font_Nrect[FONT_GLYPHS] ;
+static int Font_Built = 0 ;
+
+#define FONT_DOT(s, c, r) \
+  (((c) >= 0) && ((c) < 5) && ((r) < 9) && (((s)[r] >> (4 - (c))) & 1))
+
+
+
+static void Font_Build ()
+// the runs of each row of pixels of each glyph, a run merged with
+// the same run in the rows above it into one rectangle
+{
+  unsigned short bits[FONT_HEIGHT] ;
+  const unsigned char *s ;
+  short *q ;
+  int g, r, c, x, x0, k, n, top ;
+
+  top = FONT_ASCENT - 13 ;
+  for (g = 0 ; g < FONT_GLYPHS ; g++) {
+    s = Font_Strokes[g] ;
+    memset (bits, 0, sizeof(bits)) ;
+    for (r = 0 ; r < 9 ; r++) {
+      for (c = 0 ; c < 5 ; c++) {
+        if (!FONT_DOT (s, c, r)) continue ;
+        bits[top + 2*r] |= 1 << (2*c) ;
+        if (FONT_DOT (s, c + 1, r)) bits[top + 2*r] |= 1 << (2*c + 1) ;
+        if (FONT_DOT (s, c, r + 1)) bits[top + 2*r + 1] |= 1 << (2*c) ;
+        // diagonal steps, unless a corner already joins them
+        if (FONT_DOT (s, c + 1, r + 1) && !FONT_DOT (s, c + 1, r) && !FONT_DOT (s, c, r + 1))
+          bits[top + 2*r + 1] |= 1 << (2*c + 1) ;
+        if (FONT_DOT (s, c - 1, r + 1) && !FONT_DOT (s, c - 1, r) && !FONT_DOT (s, c, r + 1))
+          bits[top + 2*r + 1] |= 1 << (2*c - 1) ;
+      }
+    }
+
+    n = 0 ;
+    for (r = 0 ; r < FONT_HEIGHT ; r++) {
+      x = 0 ;
+      while (x < FONT_WIDTH) {
+        if (!((bits[r] >> x) & 1)) { x++ ; continue ; }
+        for (x0 = x ; (x < FONT_WIDTH) && ((bits[r] >> x) & 1) ; x++) ;
+        for (k = 0 ; k < n ; k++) {
+          q = Font_Rect[g][k] ;
+          if ((q[0] == x0) && (q[2] == x - x0) && (q[1] + q[3] == r)) break ;
+        }
+        if (k < n) { Font_Rect[g][k][3]++ ; continue ; }
+        if (n == FONT_MAX_RECTS) continue ;
+        q = Font_Rect[g][n++] ;
+        q[0] = x0 ; q[1] = r ; q[2] = x - x0 ; q[3] = 1 ;
+      }
+    }
+    Font_Nrect[g] = n ;
+  }
+
+  Font_Built = 1 ;
+}
+
+
+
+static int Font_Clip_Out (const char *s, int x, int top)
+// Clip_Out for the cells of the string s with its left edge at
+// column x and its top at row top ; builds the font if need be
+{
+  if (!Font_Built) Font_Build () ;
+  return Clip_Out (x, top, x + FONT_WIDTH * (int)strlen (s) - 1, top + FONT_HEIGHT - 1) ;
+}
+
+
+
+#define TEXT_CACHE_SIZES 8 // sizes of G_draw_text glyphs kept at once
+#define TEXT_MAX_CELL 4096 // pixels, so that the rectangles fit shorts
+
+typedef struct {
+  int w, h ;                 // the cell, 0 for a free slot
+  int ascent ;               // rows from its top to the baseline
+  unsigned int used ;        // Text_Clock when last drawn
+  short nrect[FONT_GLYPHS] ; // -1 until the glyph is first drawn
+  short rect[FONT_GLYPHS][FONT_MAX_RECTS][4] ;
+} Text_Size ;
+
+static Text_Size Text_Cache[TEXT_CACHE_SIZES] ;
+static unsigned int Text_Clock = 0 ;
+
+
+
+static Text_Size *Text_Find_Size (int w, int h)
+// the slot of the cell size w x h, taking over the one that has gone
+// longest unused if that size is not kept
+{
+  Text_Size *t, *old ;
+  int k ;
+
+  old = &Text_Cache[0] ;
+  for (k = 0 ; k < TEXT_CACHE_SIZES ; k++) {
+    t = &Text_Cache[k] ;
+    if ((t->w == w) && (t->h == h)) break ;
+    if (t->used < old->used) old = t ;
+  }
+  if (k == TEXT_CACHE_SIZES) {
+    t = old ;
+    t->w = w ;
+    t->h = h ;
+    t->ascent = (int)floor(FONT_ASCENT * (double)h / FONT_HEIGHT + 0.5) ;
+    memset (t->nrect, 0xff, sizeof(t->nrect)) ;
+  }
+  t->used = ++Text_Clock ;
+
+  return t ;
+}
+
+
+
+static const short *Text_Glyph (Text_Size *t, int g, int *nq)
+// the rectangles of glyph g at the size of t, scaled from those of
+// the built in font the first time they are asked for ; a stroke
+// keeps at least 1 pixel
+{
+  const short *p ;
+  short *q ;
+  double sx, sy ;
+  int k, a, b ;
+
+  if (t->nrect[g] < 0) {
+    if (!Font_Built) Font_Build () ;
+    sx = (double)t->w / FONT_WIDTH ;
+    sy = (double)t->h / FONT_HEIGHT ;
+    for (k = 0 ; k < Font_Nrect[g] ; k++) {
+      p = Font_Rect[g][k] ;
+      q = t->rect[g][k] ;
+      a = (int)floor(p[0] * sx + 0.5) ;
+      b = (int)floor((p[0] + p[2]) * sx + 0.5) ;
+      q[0] = a ; q[2] = (b > a) ? b - a : 1 ;
+      a = (int)floor(p[1] * sy + 0.5) ;
+      b = (int)floor((p[1] + p[3]) * sy + 0.5) ;
+      q[1] = a ; q[3] = (b > a) ? b - a : 1 ;
+    }
+    t->nrect[g] = Font_Nrect[g] ;
+  }
+
+  *nq = t->nrect[g] ;
+  return t->rect[g][0] ;
+}
+
+
+
+static int Text_Lines (int num_lines, const void *lines_of_text,
+                       double startx, double starty, double height, double x_over_y_ratio,
+                       double letter_fraction, double line_fraction,
+                       void (*glyph)(const short *q, int nq, int x, int top, void *ctx),
+                       void *ctx)
+// Draw_Text_X and Draw_Text_M : the glyphs of each line, in cached
+// rectangles, handed to glyph with the top left corner of their cell
+// and ctx
+// return 0 if the sizes are not usable, else 1
+{
+  const char **lines = (const char **)lines_of_text ;
+  const char *s ;
+  const short *q ;
+  Text_Size *t ;
+  double w, advance, y ;
+  int k, i, g, nq, x, top, len ;
+
+  if ((num_lines < 0) || (height <= 0) || (x_over_y_ratio <= 0)) return 0 ;
+  w = height * x_over_y_ratio ;
+  if ((height > TEXT_MAX_CELL) || (w > TEXT_MAX_CELL)) return 0 ;
+  t = Text_Find_Size ((int)floor(w + 0.5) > 0 ? (int)floor(w + 0.5) : 1,
+                      (int)floor(height + 0.5) > 0 ? (int)floor(height + 0.5) : 1) ;
+  advance = w * (1 + letter_fraction) ;
+
+  for (k = 0 ; k < num_lines ; k++) {
+    s = lines[k] ;
+    y = starty - k * height * (1 + line_fraction) ;
+    top = Xx_Pix_height - (int)y - t->ascent ;
+    len = (int)strlen (s) ;
+    if (len == 0) continue ;
+    if (Clip_Out ((int)floor(startx), top,
+                  (int)floor(startx + (len - 1) * advance) + t->w - 1, top + t->h - 1)) continue ;
+    for (i = 0 ; i < len ; i++) {
+      x = (int)floor(startx + i * advance) ;
+      if ((x > Clip_c1) || (x + t->w <= Clip_c0)) continue ;
+      g = (unsigned char)s[i] - FONT_FIRST ;
+      if ((g < 0) || (g >= FONT_GLYPHS)) continue ;
+      q = Text_Glyph (t, g, &nq) ;
+      glyph (q, nq, x, top, ctx) ;
+    }
+  }
+
+  return 1 ;
+}
+
 
 
 
@@ -166,12 +721,14 @@ int G_choose_repl_display()
 
 
 int Clear_Buffer_X() 
+// the depth buffer of the _3d fills is cleared along with the pixels
 {
    unsigned long int p ;
    XFillRectangle(XxDisplay, XxDrawable, XxPixmapContext, 
                                            0, 0, Xx_Pix_width, Xx_Pix_height);
    XFlush(XxDisplay);  
    Last_Clear_Buffer_Pixel = Current_Color_Pixel ;
+   Mm_Clear_Depth() ;
 
    return 1 ;
 }
@@ -298,12 +855,14 @@ int Init_X (double Dswidth, double Dsheight)
 
     XxPixmapContext = XCreateGC(XxDisplay, XxPixmap, 0, 0);
     if (!XxPixmapContext) return 0;
+    Clip_Whole_Window () ;
 
 
     XxColormap = DefaultColormap(XxDisplay, XxScreenNumber);
 
 
     XxFontInfo = XLoadQueryFont(XxDisplay, XxFont) ;
+    Xx_Advance_Font = NULL ;
     //    XSetFont(XxDisplay, XxWindowContext, XxFontInfo->fid) ;
 
     // XSetFont(XxDisplay, XxPixmapContext, XxFontInfo->fid) ;
@@ -340,6 +899,7 @@ int Close_Down_X()
     XFreeGC(XxDisplay, XxPixmapContext);
     XFreePixmap(XxDisplay, XxPixmap);
     XCloseDisplay(XxDisplay);
+    Mm_Free_Depth() ;
 
     return 1 ;    
 }
@@ -585,7 +1145,8 @@ int Safe_Point_X (double Dx, double Dy)
   int x = (int)Dx ;
   int y = (int)Dy ;
 
-    if ((x < 0) || (y < 0) || (x >= Xx_Pix_width) || (y >= Xx_Pix_height)) {return 0 ;}
+    if ((x < Clip_c0) || (x > Clip_c1) ||
+        (Xx_Pix_height - 1 - y < Clip_r0) || (Xx_Pix_height - 1 - y > Clip_r1)) {return 0 ;}
     XDrawPoint(XxDisplay, XxDrawable, XxPixmapContext,
                x,  Xx_Pix_height - 1 - y) ;
     return 1 ;
@@ -615,6 +1176,54 @@ int Line_X (double Dxs, double Dys, double Dxe, double Dye)
 
 
 
+int Clip_Line_Liang_Barsky (double *xs, double *ys, double *xe, double *ye,
+                            double xmin, double ymin,
+                            double xmax, double ymax)
+// Clip the segment (xs,ys)-(xe,ye) to the box [xmin,xmax] x [ymin,ymax]
+// in a single pass : the segment is P(t) = S + t(E - S), 0 <= t <= 1,
+// and each of the four edges can only raise the entering t0 or
+// lower the leaving t1.  At most two divides, no branches per edge pair.
+// return 0 if nothing is left, else 1 with the ends moved onto the box
+{
+  double dx = *xe - *xs ;
+  double dy = *ye - *ys ;
+  double p[4], q[4] ;
+  double t0 = 0.0, t1 = 1.0, r ;
+  double x0 = *xs, y0 = *ys ;
+  int k ;
+
+  p[0] = -dx ; q[0] = x0 - xmin ;
+  p[1] =  dx ; q[1] = xmax - x0 ;
+  p[2] = -dy ; q[2] = y0 - ymin ;
+  p[3] =  dy ; q[3] = ymax - y0 ;
+
+  for (k = 0 ; k < 4 ; k++) {
+    if (p[k] == 0) {
+      // parallel to this edge ... entirely outside or no constraint
+      if (q[k] < 0) return 0 ;
+    } else {
+      r = q[k] / p[k] ;
+      if (p[k] < 0) {
+        // entering
+        if (r > t1) return 0 ;
+        if (r > t0) t0 = r ;
+      } else {
+        // leaving
+        if (r < t0) return 0 ;
+        if (r < t1) t1 = r ;
+      }
+    }
+  }
+
+  if (t1 < 1.0) { *xe = x0 + t1*dx ; *ye = y0 + t1*dy ; }
+  if (t0 > 0.0) { *xs = x0 + t0*dx ; *ys = y0 + t0*dy ; }
+
+  return 1 ;
+}
+
+
+
+
 int Safe_Line_X (double Dxs, double Dys, double Dxe, double Dye)
 {
   int ixs = (int)Dxs ;
@@ -623,8 +1232,12 @@ int Safe_Line_X (double Dxs, double Dys, double Dxe, double Dye)
   int iye = (int)Dye ;
 
   double xs, ys, xe, ye ; // doubles for accuracy in clipping 
-  double t, xedge, yedge ;
+  double m = (Current_Pen_Width > 1) ? Current_Pen_Width : 0 ; // a wide pen reaches past the ends
 
+  // the server clips to the clip rectangle, pixel by pixel ; only
+  // a line that misses it altogether is worth catching here
+  if (Clip_Out (((ixs < ixe) ? ixs : ixe) - (int)m, Xx_Pix_height - 1 - ((iys > iye) ? iys : iye) - (int)m,
+                ((ixs > ixe) ? ixs : ixe) + (int)m, Xx_Pix_height - 1 - ((iys < iye) ? iys : iye) + (int)m)) return 1 ;
 
   if (  (ixs >= 0 ) && (ixs < Xx_Pix_width)  
      && (ixe >= 0 ) && (ixe < Xx_Pix_width)  
@@ -643,143 +1256,17 @@ int Safe_Line_X (double Dxs, double Dys, double Dxe, double Dye)
 
   xs = ixs ; ys = iys ; xe = ixe ; ye = iye ;
 
-// start to end 
-// in       in      leave line alone...draw it all 
-// in      out      replace end 
-// out      in      replace start 
-// out     out      don't draw the line 
-
-
-// clip against all 4 sides of screen 
-
-
-
-// first clip against y = 0 
-
- yedge = 0 ;
- if (ys >= yedge) {
-     if (ye >= yedge) {
-         // start is in, end is in , leave alone...next test 
-     }
-     else {
-         // start is in, end is out, replace end...next test 
-         t = (yedge - ys)/(ye - ys) ; 
-             // ye cannot be ys .. no div by 0 worry 
-         xe = xs + t*(xe - xs) ;
-         ye = yedge ;
-     }
- } else {
-     if (ye >= yedge) {
-         //start is out, end is in, replace start...next test 
-         t = (yedge - ys)/(ye - ys) ; 
-             // ye cannot be ys .. no div by 0 worry 
-         xs = xs + t*(xe - xs) ;
-         ys = yedge ;
-
-     }
-     else {
-         // both are out...don't draw line at all 
-         goto CLend ;
-     }
- }
-
-// second, clip against y = Xx_Pix_height - 1 
-
- yedge = Xx_Pix_height - 1 ;
- if (ys <= yedge) {
-     if (ye <= yedge) {
-         // start is in, end is in , leave alone...next test 
-     }
-     else {
-         // start is in, end is out, replace end...next test 
-         t = (yedge - ys)/(ye - ys) ; 
-             // ye cannot be ys .. no div by 0 worry 
-         xe = xs + t*(xe - xs) ;
-         ye = yedge ;
-     }
- } else {
-     if (ye <= yedge) {
-         //start is out, end is in, replace start...next test 
-         t = (yedge - ys)/(ye - ys) ; 
-             // ye cannot be ys .. no div by 0 worry 
-         xs = xs + t*(xe - xs) ;
-         ys = yedge ;
-
-     }
-     else {
-         // both are out...don't draw line at all 
-         goto CLend ;
-     }
- }
-
-
-// third, clip against x = 0 
-
- xedge = 0 ;
- if (xs >= xedge) {
-     if (xe >= xedge) {
-         // start is in, end is in , leave alone...next test 
-     }
-     else {
-         // start is in, end is out, replace end...next test 
-         t = (xedge - xs)/(xe - xs) ; 
-             // xe cannot be xs .. no div by 0 worry 
-         ye = ys + t*(ye - ys) ;
-         xe = xedge ;
-     }
- } else {
-     if (xe >= xedge) {
-         //start is out, end is in, replace start...next test 
-         t = (xedge - xs)/(xe - xs) ; 
-             // xe cannot be xs .. no div by 0 worry 
-         ys = ys + t*(ye - ys) ;
-         xs = xedge ;
-
-     }
-     else {
-         // both are out...don't draw line at all 
-         goto CLend ;
-     }
- }
-
-// finally, clip against x = Xx_Pix_width - 1 
-
- xedge = Xx_Pix_width - 1 ;
- if (xs <= xedge) {
-     if (xe <= xedge) {
-         // start is in, end is in , leave alone...next test 
-     }
-     else {
-         // start is in, end is out, replace end...next test 
-         t = (xedge - xs)/(xe - xs) ; 
-             // xe cannot be xs .. no div by 0 worry 
-         ye = ys + t*(ye - ys) ;
-         xe = xedge ;
-     }
- } else {
-     if (xe <= xedge) {
-         //start is out, end is in, replace start...next test 
-         t = (xedge - xs)/(xe - xs) ; 
-             // xe cannot be xs .. no div by 0 worry 
-         ys = ys + t*(ye - ys) ;
-         xs = xedge ;
-
-     }
-     else {
-         // both are out...don't draw line at all 
-         goto CLend ;
-     }
- }
-
+  // clip against all 4 sides of screen at once 
+  if (Clip_Line_Liang_Barsky (&xs,&ys, &xe,&ye,
+                              -m, -m, Xx_Pix_width - 1 + m, Xx_Pix_height - 1 + m)) {
 
     XDrawLine (XxDisplay, XxDrawable, XxPixmapContext,
                (int)xs, (int)(Xx_Pix_height-1-ys),
                (int)xe, (int)(Xx_Pix_height-1-ye) );
 
+  }
 
- CLend : 
-
-    return 1 ;
+  return 1 ;
 
 }
 
@@ -794,6 +1281,10 @@ int Rectangle_X (double Dxlow, double Dylow, double Dwidth, double Dheight)
   int ylow = (int)Dylow ;
   int width = (int)Dwidth ;
   int height = (int)Dheight ; 
+  int m = Clip_Pen_Margin () ;
+
+  if (Clip_Out (xlow - m, Xx_Pix_height - 1 - ylow - height - m,
+                xlow + width + m, Xx_Pix_height - 1 - ylow + m)) return 1 ;
 
   XDrawRectangle(XxDisplay, XxDrawable, XxPixmapContext,
                    xlow,  Xx_Pix_height - ylow - height,
@@ -812,6 +1303,9 @@ int Fill_Rectangle_X (double Dxlow, double Dylow, double Dwidth, double Dheight)
   int width = (int)Dwidth ;
   int height = (int)Dheight ; 
 
+  if (Clip_Out (xlow, Xx_Pix_height - ylow - height,
+                xlow + width - 1, Xx_Pix_height - 1 - ylow)) return 1 ;
+
   XFillRectangle(XxDisplay, XxDrawable, XxPixmapContext,
                    xlow, Xx_Pix_height - ylow - height,
                    width, height);
@@ -845,6 +1339,8 @@ int Triangle_X (double Dx1, double Dy1,
   Points[3].x = Points[0].x;
   Points[3].y = Points[0].y;
 
+  if (Clip_Out_XPoints (Points, 3, Clip_Pen_Margin ())) return 1 ;
+
   XDrawLines(XxDisplay, XxDrawable,XxPixmapContext,
                                Points, 4, CoordModeOrigin);
 
@@ -875,6 +1371,7 @@ int Fill_Triangle_X (double Dx1, double Dy1,
   Points[2].x = (x3);
   Points[2].y = (Xx_Pix_height-1-y3);
 
+  if (Clip_Out_XPoints (Points, 3, 0)) return 1 ;
 
   XFillPolygon(XxDisplay, XxDrawable, XxPixmapContext,
                 Points, 3, Convex, CoordModeOrigin);
@@ -886,9 +1383,75 @@ int Fill_Triangle_X (double Dx1, double Dy1,
 
 
 
+int Fill_Triangle_Rgb_X (double x[3], double y[3], double rgb[3][3])
+// X has no shaded fill, so use the average color
+// and leave the current color as it was
+{
+  int r = Current_Red_Int ;
+  int g = Current_Green_Int ;
+  int b = Current_Blue_Int ;
+
+  Set_Color_Rgb_DX ((rgb[0][0] + rgb[1][0] + rgb[2][0]) / 3,
+                    (rgb[0][1] + rgb[1][1] + rgb[2][1]) / 3,
+                    (rgb[0][2] + rgb[1][2] + rgb[2][2]) / 3) ;
+  Fill_Triangle_X (x[0],y[0], x[1],y[1], x[2],y[2]) ;
+  Set_Color_Rgb_X (r,g,b) ;
+
+  return 1 ;  
+}
+
+
+
+
+
+static int Xx_Fill_3d (double *x, double *y, double *z, int npts)
+// Fill_Triangle_3d_X and Fill_Polygon_3d_X : the fan from vertex 0
+// goes through the depth test of the memory backend, on the client,
+// and the pixels that pass are sent as rectangles, XX_BATCH to a
+// request.  return 0 if out of memory, else 1
+{
+  XRectangle rect[XX_BATCH] ;
+  Xx_Batch b ;
+  double tx[3], row[3], tz[3] ;
+  int i, k, s = 1 ;
+
+  b.rect = rect ;
+  b.n = 0 ;
+  tx[0] = x[0] ; row[0] = Xx_Pix_height - 1 - y[0] ; tz[0] = z[0] ;
+  for (i = 1 ; (i < npts - 1) && s ; i++) {
+    for (k = 1 ; k < 3 ; k++) {
+      tx[k] = x[i+k-1] ; row[k] = Xx_Pix_height - 1 - y[i+k-1] ; tz[k] = z[i+k-1] ;
+    }
+    s = Mm_Fill_Triangle_3d (tx, row, tz, &b) ;
+  }
+  if (b.n > 0) XFillRectangles(XxDisplay, XxDrawable, XxPixmapContext, rect, b.n) ;
+
+  return s ;
+}
+
+
+
+int Fill_Triangle_3d_X (double x0, double y0, double z0,
+                        double x1, double y1, double z1,
+                        double x2, double y2, double z2)
+// the same pixels as Fill_Triangle_3d_M
+{
+  double x[3], y[3], z[3] ;
+
+  x[0] = x0 ; y[0] = y0 ; z[0] = z0 ;
+  x[1] = x1 ; y[1] = y1 ; z[1] = z1 ;
+  x[2] = x2 ; y[2] = y2 ; z[2] = z2 ;
+
+  return Xx_Fill_3d (x, y, z, 3) ;
+}
+
+
+
+
+
 int Polygon_X (int *x, int *y, int npts)
 {
-   XPoint xpoint[1000] ;
+   XPoint xpoint[1001] ;
    int k ;
 
    if (npts <= 0) return 0 ;
@@ -905,11 +1468,12 @@ int Polygon_X (int *x, int *y, int npts)
         xpoint[k].y = Xx_Pix_height -1 - y[k] ;
    }
 
+   // back to the start in the same request, so that a wide
+   // pen joins the last corner like the others
+   xpoint[npts] = xpoint[0] ;
+   if (Clip_Out_XPoints (xpoint, npts, Clip_Pen_Margin ())) return 1 ;
    XDrawLines(XxDisplay,XxDrawable,XxPixmapContext,
-                       xpoint,npts,  CoordModeOrigin);
-   XDrawLine(XxDisplay,XxDrawable,XxPixmapContext,
-                    xpoint[0].x, xpoint[0].y,
-                         xpoint[npts-1].x, xpoint[npts-1].y ) ;
+                       xpoint,npts+1,  CoordModeOrigin);
 
    return 1 ;
 }
@@ -919,7 +1483,7 @@ int Polygon_X (int *x, int *y, int npts)
 int Polygon_DX (double *x, double *y, double Dnpts)
 {
   int npts = (int)Dnpts ;
-   XPoint xpoint[1000] ;
+   XPoint xpoint[1001] ;
    int k ;
 
    if (npts <= 0) return 0 ;
@@ -936,11 +1500,12 @@ int Polygon_DX (double *x, double *y, double Dnpts)
         xpoint[k].y = (int)(Xx_Pix_height -1 - y[k]) ;
    }
 
+   // back to the start in the same request, so that a wide
+   // pen joins the last corner like the others
+   xpoint[npts] = xpoint[0] ;
+   if (Clip_Out_XPoints (xpoint, npts, Clip_Pen_Margin ())) return 1 ;
    XDrawLines(XxDisplay,XxDrawable,XxPixmapContext,
-                       xpoint,npts,  CoordModeOrigin);
-   XDrawLine(XxDisplay,XxDrawable,XxPixmapContext,
-                    xpoint[0].x, xpoint[0].y,
-                         xpoint[npts-1].x, xpoint[npts-1].y ) ;
+                       xpoint,npts+1,  CoordModeOrigin);
 
    return 1 ;
 }
@@ -966,6 +1531,7 @@ int Fill_Polygon_X (int *x, int *y, int npts)
         xpoint[k].y = Xx_Pix_height -1 - y[k] ;
    }
 
+   if (Clip_Out_XPoints (xpoint, npts, 0)) return 1 ;
 
    XFillPolygon(XxDisplay,XxDrawable,XxPixmapContext,
                 xpoint,npts,Nonconvex,CoordModeOrigin);   
@@ -996,6 +1562,7 @@ int Fill_Polygon_DX (double *x, double *y, double Dnpts)
         xpoint[k].y = (int)(Xx_Pix_height -1 - y[k]) ;
    }
 
+   if (Clip_Out_XPoints (xpoint, npts, 0)) return 1 ;
 
    XFillPolygon(XxDisplay,XxDrawable,XxPixmapContext,
                 xpoint,npts,Nonconvex,CoordModeOrigin);   
@@ -1007,41 +1574,105 @@ int Fill_Polygon_DX (double *x, double *y, double Dnpts)
 
 
 
-int FLAWED_Horizontal_Single_Pixel_Line_X (double Dx0, double Dx1, double Dy)
-{
-  //  Line_X(Dx0,Dy,  Dx1,Dy) ; return 1 ; // this is ok
-  //  But below is NOT...
-  // consider drawing a horizontal line where both points are outside of the
-  // window.  This code maps both ends to the boundary and so will draw at
-  // least a single point when it shouldn't draw anything.
-   int x0 = (int)Dx0 ;
-   int x1 = (int)Dx1 ;
-   int y = (int)Dy ;
-   int t ;
 
-   // protect against an offscreen line
-   if (y < 0) return 0 ;
-   if (y >= Xx_Pix_height) return 0 ;
+int Fill_Polygon_3d_X (double *x, double *y, double *z, double Dnpts)
+// the same pixels as Fill_Polygon_3d_M
+{
+   if ((int)Dnpts < 3) return 0 ;
 
-   if (x0 < 0) x0 = 0 ;
-   else if (x0 >= Xx_Pix_width) x0 = (Xx_Pix_width - 1) ;
-   if (x1 < 0) x1 = 0 ;
-   else if (x1 >= Xx_Pix_width)  x1 = (Xx_Pix_width - 1) ;
-   // end protection code
+   return Xx_Fill_3d (x, y, z, (int)Dnpts) ;
+}
 
-   if (x1 < x0) { t = x1 ; x1 = x0 ; x0 = t ; }
 
-   Line_X (x0,y, x1,y) ;
-   
-   return 1 ;
-} 
 
 
+int Polyline_DX (double *x, double *y, double Dnpts)
+// an open path, with joins at the inner points only
+{
+  int npts = (int)Dnpts ;
+   XPoint xpoint[1000] ;
+   int k ;
 
+   if (npts <= 0) return 0 ;
 
+   if (npts > 1000) {
+      printf("\nPolyline_X has been asked to deal with %d points.\n",
+             npts) ;
+      printf("Points past first 1000 ignored.\n") ;
+      npts = 1000 ;
+   }
 
-int Horizontal_Single_Pixel_Line_X (double Dx0, double Dx1, double Dy)
-{
+   for (k = 0 ; k < npts ; k++) {
+        xpoint[k].x = (int)x[k] ;
+        xpoint[k].y = (int)(Xx_Pix_height -1 - y[k]) ;
+   }
+
+   if (Clip_Out_XPoints (xpoint, npts, Clip_Pen_Margin ())) return 1 ;
+   XDrawLines(XxDisplay,XxDrawable,XxPixmapContext,
+                       xpoint,npts,  CoordModeOrigin);
+
+   return 1 ;
+}
+
+
+
+
+int Polygon_XPoints_X (XPoint *xpoint, int npts)
+// xpoint[] is already in X device coordinates (y flipped)
+{
+   XPoint *closed ;
+
+   if (npts <= 0) return 0 ;
+   if (Clip_Out_XPoints (xpoint, npts, Clip_Pen_Margin ())) return 1 ;
+
+   if (Current_Pen_Width > 1) {
+     // a wide pen needs the closing corner in the same request
+     // to join it ; that takes a copy with room for it
+     closed = (XPoint *) malloc((npts + 1) * sizeof(XPoint)) ;
+     if (closed != NULL) {
+       memcpy(closed, xpoint, npts * sizeof(XPoint)) ;
+       closed[npts] = xpoint[0] ;
+       XDrawLines(XxDisplay,XxDrawable,XxPixmapContext,
+                           closed,npts+1,  CoordModeOrigin);
+       free(closed) ;
+       return 1 ;
+     }
+   }
+
+   XDrawLines(XxDisplay,XxDrawable,XxPixmapContext,
+                       xpoint,npts,  CoordModeOrigin);
+   XDrawLine(XxDisplay,XxDrawable,XxPixmapContext,
+                    xpoint[0].x, xpoint[0].y,
+                         xpoint[npts-1].x, xpoint[npts-1].y ) ;
+
+   return 1 ;
+}
+
+
+
+int Fill_Polygon_XPoints_X (XPoint *xpoint, int npts)
+// xpoint[] is already in X device coordinates (y flipped)
+// so there is no copy and no 1000 point limit
+{
+   if (npts <= 0) return 0 ;
+   if (Clip_Out_XPoints (xpoint, npts, 0)) return 1 ;
+
+   XFillPolygon(XxDisplay,XxDrawable,XxPixmapContext,
+                xpoint,npts,Nonconvex,CoordModeOrigin);   
+
+   return 1 ;
+}
+
+
+
+
+int FLAWED_Horizontal_Single_Pixel_Line_X (double Dx0, double Dx1, double Dy)
+{
+  //  Line_X(Dx0,Dy,  Dx1,Dy) ; return 1 ; // this is ok
+  //  But below is NOT...
+  // consider drawing a horizontal line where both points are outside of the
+  // window.  This code maps both ends to the boundary and so will draw at
+  // least a single point when it shouldn't draw anything.
    int x0 = (int)Dx0 ;
    int x1 = (int)Dx1 ;
    int y = (int)Dy ;
@@ -1051,19 +1682,47 @@ int Horizontal_Single_Pixel_Line_X (double Dx0, double Dx1, double Dy)
    if (y < 0) return 0 ;
    if (y >= Xx_Pix_height) return 0 ;
 
+   if (x0 < 0) x0 = 0 ;
+   else if (x0 >= Xx_Pix_width) x0 = (Xx_Pix_width - 1) ;
+   if (x1 < 0) x1 = 0 ;
+   else if (x1 >= Xx_Pix_width)  x1 = (Xx_Pix_width - 1) ;
+   // end protection code
+
+   if (x1 < x0) { t = x1 ; x1 = x0 ; x0 = t ; }
+
+   Line_X (x0,y, x1,y) ;
+   
+   return 1 ;
+} 
+
+
+
+
+
+int Horizontal_Single_Pixel_Line_X (double Dx0, double Dx1, double Dy)
+{
+   int x0 = (int)Dx0 ;
+   int x1 = (int)Dx1 ;
+   int y = (int)Dy ;
+   int t ;
+
+   // protect against an offscreen (or clipped) line
+   if (Xx_Pix_height - 1 - y < Clip_r0) return 0 ;
+   if (Xx_Pix_height - 1 - y > Clip_r1) return 0 ;
+
    
    if (x0 > x1) { t = x1 ; x1 = x0 ; x0 = t ; } // now we know  x0 <= x1
 
 
    
-   if (x1 < 0) return 0 ;
-   if (x0 >= Xx_Pix_width) return 0 ;
-      // now we know that x1 >= 0  and  x0 < Xx_Pix_width
+   if (x1 < Clip_c0) return 0 ;
+   if (x0 > Clip_c1) return 0 ;
+      // now we know that x1 >= Clip_c0  and  x0 <= Clip_c1
 
 
    
-   if (x0 < 0) x0 = 0 ; // this makes x0 STILL less than or equal to x1 because of above.
-   if (x1 >= Xx_Pix_width) x1 = Xx_Pix_width - 1 ; // still guarantees x0 <= x1
+   if (x0 < Clip_c0) x0 = Clip_c0 ; // this makes x0 STILL less than or equal to x1 because of above.
+   if (x1 > Clip_c1) x1 = Clip_c1 ; // still guarantees x0 <= x1
    
    // end protection code
 
@@ -1081,6 +1740,45 @@ int Horizontal_Single_Pixel_Line_X (double Dx0, double Dx1, double Dy)
 
 
 
+static void Circle_Octants (int a, int b, int r, int oct[8])
+// How much of each octant of the midpoint circle of Circle_X and
+// Circle_M is in the clip rectangle : 0 none, 1 all, 2 some, each point needs
+// checking.  Octant k is the points (a +- x, b +- y), swapped for k >= 4,
+// in the order of the loops below ; its long coordinate runs from about
+// r/sqrt(2) to r and the short one from 0 to about r/sqrt(2).
+{
+  int lo = (int)(r * M_SQRT1_2) - 1 ;
+  int ylo = Xx_Pix_height - 1 - Clip_r1 ;
+  int yhi = Xx_Pix_height - 1 - Clip_r0 ;
+  int k, u0, u1, v0, v1, x0, x1, y0, y1 ;
+
+  for (k = 0 ; k < 8 ; k++) {
+    if (k & 4) { u0 = 0 ; u1 = lo + 2 ; v0 = lo ; v1 = r ; }
+    else       { u0 = lo ; u1 = r ; v0 = 0 ; v1 = lo + 2 ; }
+    if (k & 1) { x0 = a - u1 ; x1 = a - u0 ; } else { x0 = a + u0 ; x1 = a + u1 ; }
+    if (k & 2) { y0 = b - v1 ; y1 = b - v0 ; } else { y0 = b + v0 ; y1 = b + v1 ; }
+    if ((x1 < Clip_c0) || (x0 > Clip_c1) || (y1 < ylo) || (y0 > yhi)) oct[k] = 0 ;
+    else if ((x0 >= Clip_c0) && (x1 <= Clip_c1) && (y0 >= ylo) && (y1 <= yhi)) oct[k] = 1 ;
+    else oct[k] = 2 ;
+  }
+}
+
+
+
+// the point of octant k for step (x,y) of the midpoint circle ; the
+// octants that repeat a point (on an axis or the diagonal) skip it
+#define CIRCLE_OCTANT_POINT(k, px, py)                                  \
+  if (k & 4) {                                                          \
+    if (x == y) continue ;                                              \
+    px = (k & 1) ? a - y : a + y ; py = (k & 2) ? b - x : b + x ;       \
+    if (((k & 1) && (y == 0)) || ((k & 2) && (x == 0))) continue ;      \
+  } else {                                                              \
+    px = (k & 1) ? a - x : a + x ; py = (k & 2) ? b - y : b + y ;       \
+    if (((k & 1) && (x == 0)) || ((k & 2) && (y == 0))) continue ;      \
+  }
+
+
+
 int Circle_X (double Da, double Db, double Dr)
 {
  int a = (int)Da ;
@@ -1088,18 +1786,44 @@ int Circle_X (double Da, double Db, double Dr)
  int r = (int)Dr ;
 
  int x,y,e,e1,e2 ;
+ int oct[8], k, px, py, n ;
+ XPoint p[XX_BATCH] ;
+
+ if (Current_Pen_Width > 1) {
+   // the server strokes the arc with the GC's line width
+   int m = (int)ceil(Current_Pen_Width) ;
+   if (Clip_Out (a - r - m, Xx_Pix_height - 1 - b - r - m,
+                 a + r + m, Xx_Pix_height - 1 - b + r + m)) return 1 ;
+   XDrawArc(XxDisplay, XxDrawable, XxPixmapContext,
+            a - r, Xx_Pix_height - 1 - b - r, 2*r, 2*r, 0, 360*64) ;
+   return 1 ;
+ }
+
+ if (r < 0) return 1 ;
+ Circle_Octants (a, b, r, oct) ;
+ if (oct[0] + oct[1] + oct[2] + oct[3] + oct[4] + oct[5] + oct[6] + oct[7] == 0) return 1 ;
 
  x = r ;
  y = 0 ;
  e = 0;
+ n = 0 ;
 
  while (x >= y) {
 
-       Safe_Point_X( a+x,b+y) ;   Safe_Point_X( a-x,b+y) ;
-       Safe_Point_X( a+x,b-y) ;   Safe_Point_X( a-x,b-y) ;
-
-       Safe_Point_X( a+y,b+x) ;   Safe_Point_X( a-y,b+x) ;
-       Safe_Point_X( a+y,b-x) ;   Safe_Point_X( a-y,b-x) ;
+       for (k = 0 ; k < 8 ; k++) {
+         if (oct[k] == 0) continue ;
+         CIRCLE_OCTANT_POINT(k, px, py) ;
+         if ((oct[k] == 2) &&
+             ((px < Clip_c0) || (px > Clip_c1) ||
+              (Xx_Pix_height - 1 - py < Clip_r0) || (Xx_Pix_height - 1 - py > Clip_r1))) continue ;
+         p[n].x = px ;
+         p[n].y = Xx_Pix_height - 1 - py ;
+         n++ ;
+       }
+       if (n > XX_BATCH - 8) {
+         XDrawPoints(XxDisplay, XxDrawable, XxPixmapContext, p, n, CoordModeOrigin) ;
+         n = 0 ;
+       }
 
        e1 =  e + y + y + 1 ;
        e2 = e1 - x - x + 1 ;
@@ -1112,6 +1836,8 @@ int Circle_X (double Da, double Db, double Dr)
 
      } 
 
+ if (n > 0) XDrawPoints(XxDisplay, XxDrawable, XxPixmapContext, p, n, CoordModeOrigin) ;
+
   return 1 ; 
 } 
 
@@ -1129,6 +1855,8 @@ int Fill_Circle_X (double Da, double Db, double Dr)
 
  int x,y,e,e1,e2 ;
 
+ if (Clip_Out (a - r, Xx_Pix_height - 1 - b - r, a + r, Xx_Pix_height - 1 - b + r)) return 1 ;
+
  x = r ;
  y = 0 ;
  e = 0;
@@ -1159,189 +1887,771 @@ int Fill_Circle_X (double Da, double Db, double Dr)
 
 
 
-int Font_Pixel_Height_X ()
-// Returns the height of the font in pixels. 
+#define ELLIPSE_MAX_MIDPOINT 16384 // radii up to which the rows are traced
+
+static int *Ellipse_Rows (int rx, int ry, int y0, int y1)
+// The midpoint ellipse of radii rx, ry, as the rightmost x of each row
+// of its first quadrant : w[y - y0] for y = y0..y1+1, where w at ry+1
+// is -1.  Row y of the outline is min(w[y+1]+1, w[y]) .. w[y], and of
+// the fill 0 .. w[y] ; the other quadrants mirror them.  The decision
+// values are 4 times the usual ones, to stay in integers ; with radii
+// of at most ELLIPSE_MAX_MIDPOINT they stay far inside a long long.
+// The trace stops below row y0.
+// return an array to free, or NULL if out of memory
 {
-     return XxFontInfo->max_bounds.ascent + XxFontInfo->max_bounds.descent;
-}
+  long long rx2 = (long long)rx * rx ;
+  long long ry2 = (long long)ry * ry ;
+  long long px, py, p ;
+  int x, y ;
+  int *w ;
+
+  w = (int *) malloc((y1 - y0 + 2) * sizeof(int)) ;
+  if (w == NULL) return NULL ;
+  if (y1 == ry) w[ry + 1 - y0] = -1 ;
+  if (ry == 0) { w[0] = rx ; return w ; }
+
+#define ELLIPSE_ROW(y, x) if (((y) >= y0) && ((y) <= y1 + 1)) w[(y) - y0] = (x)
+
+  x = 0 ;
+  y = ry ;
+  px = 0 ;
+  py = 2 * rx2 * y ;
+
+  // region 1 : the slope is under 1, one step in x at a time
+  p = 4*ry2 - 4*rx2*ry + rx2 ;
+  while (px < py) {
+    ELLIPSE_ROW (y, x) ;
+    x++ ;
+    px += 2 * ry2 ;
+    if (p < 0) p += 4 * (ry2 + px) ;
+    else {
+      y-- ;
+      if (y < y0) return w ;
+      py -= 2 * rx2 ;
+      p += 4 * (ry2 + px - py) ;
+    }
+  }
 
+  // region 2 : one step in y at a time
+  p = ry2*(2*x + 1)*(2*x + 1) + 4*rx2*(y - 1)*(y - 1) - 4*rx2*ry2 ;
+  while (y >= y0) {
+    ELLIPSE_ROW (y, x) ;
+    y-- ;
+    py -= 2 * rx2 ;
+    if (p > 0) p += 4 * (rx2 - py) ;
+    else {
+      x++ ;
+      px += 2 * ry2 ;
+      p += 4 * (rx2 - py + px) ;
+    }
+  }
 
+#undef ELLIPSE_ROW
 
-// the void * delcarations below allow for the passing of
-// arrays of characters (usual usage) but also, for instance,
-// an array of doubles that is composed of packed characters
+  return w ;
+}
 
 
-int String_Pixel_Width_X (const void *s)
-// Returns the length, in pixels, of the string s 
+
+static double Ellipse_Half_Width (const int *w, int k, double d, double rx, double ry)
+// the rightmost x of row d of the first quadrant : w[k] from
+// Ellipse_Rows if there is w, otherwise from the equation, the
+// nearest x on the row or on flat rows as far as the curve stays
+// within half a row, as the midpoint trace does
 {
-     int len;
+  double x, xh ;
+
+  if (w != NULL) return w[k] ;
+  if (d > ry) return -1 ;
+  if ((ry == 0) || (d == 0)) return rx ;
+  x = floor(rx * sqrt(1 - (d / ry) * (d / ry)) + 0.5) ;
+  xh = floor(rx * sqrt(1 - ((d - 0.5) / ry) * ((d - 0.5) / ry))) ;
+  return (xh > x) ? xh : x ;
+}
 
-     len = strlen((char *)s);
 
-     return XTextWidth(XxFontInfo, (char *)s, len);
-}
 
+static int Ellipse_Spans (double Da, double Db, double Drx, double Dry, int fill,
+                          void (*span)(int x0, int x1, int row, void *ctx), void *ctx)
+// Xx_Ellipse and Mm_Ellipse : the runs of all four quadrants, on the
+// rows the clip rectangle keeps, clipped to it and handed to span in
+// device coordinates.  Only those rows are traced ; radii past
+// ELLIPSE_MAX_MIDPOINT take the half width of each row from the
+// equation of the ellipse instead.  The bounds are worked out in
+// doubles, so that no center or radius can overflow an int.
+// return 0 if a radius is negative or out of memory, else 1
+{
+  double a = trunc(Da) ;
+  double b = trunc(Db) ;
+  double rx = trunc(Drx) ;
+  double ry = trunc(Dry) ;
+  double cb, ylo, yhi, y, hi, lo, x0, x1, row ;
+  int *w = NULL ;
+  int k, nrows, side, m ;
+
+  if ((rx < 0) || (ry < 0)) return 0 ;
+  cb = Xx_Pix_height - 1 - b ; // the device row of the center
+  if ((Clip_c0 > Clip_c1) || (a + rx < Clip_c0) || (a - rx > Clip_c1) ||
+      (cb + ry < Clip_r0) || (cb - ry > Clip_r1)) return 1 ;
+
+  // the distances from the center of the rows that are kept
+  ylo = (cb < Clip_r0) ? Clip_r0 - cb : ((cb > Clip_r1) ? cb - Clip_r1 : 0) ;
+  yhi = (fabs(Clip_r0 - cb) > fabs(Clip_r1 - cb)) ? fabs(Clip_r0 - cb) : fabs(Clip_r1 - cb) ;
+  if (yhi > ry) yhi = ry ;
+  nrows = (int)(yhi - ylo) + 1 ;
+
+  if ((rx <= ELLIPSE_MAX_MIDPOINT) && (ry <= ELLIPSE_MAX_MIDPOINT)) {
+    w = Ellipse_Rows ((int)rx, (int)ry, (int)ylo, (int)yhi) ;
+    if (w == NULL) return 0 ;
+  }
+
+  for (k = 0 ; k < nrows ; k++) {
+    y = ylo + k ;
+    hi = Ellipse_Half_Width (w, k, y, rx, ry) ;
+    lo = Ellipse_Half_Width (w, k + 1, y + 1, rx, ry) ;
+    lo = fill ? 0 : ((lo + 1 < hi) ? lo + 1 : hi) ;
+
+    for (side = 0 ; side < 2 ; side++) {
+      if ((side == 1) && (y == 0)) break ;
+      row = (side == 0) ? cb - y : cb + y ;
+      if ((row < Clip_r0) || (row > Clip_r1)) continue ;
+      for (m = 0 ; m < 2 ; m++) {
+        if (lo == 0) { if (m == 1) break ; x0 = a - hi ; x1 = a + hi ; }
+        else if (m == 0) { x0 = a + lo ; x1 = a + hi ; }
+        else { x0 = a - hi ; x1 = a - lo ; }
+        if (x0 < Clip_c0) x0 = Clip_c0 ;
+        if (x1 > Clip_c1) x1 = Clip_c1 ;
+        if (x0 <= x1) span ((int)x0, (int)x1, (int)row, ctx) ;
+      }
+    }
+  }
 
+  free(w) ;
+  return 1 ;
+}
 
 
 
-int Draw_String_X (const void *s, double Dx, double Dy)
-// Draw the string s, with the lower left hand corner at (x,y)
+static int Xx_Add_Run (XRectangle *rect, int n, int x0, int x1, int y)
+// a run of pixels as a one pixel high rectangle, clipped to the clip
+// rectangle ; a full batch is sent.  return the new count
 {
-  int x = (int)Dx ;
-  int y = (int)Dy ;
+  if ((Xx_Pix_height - 1 - y < Clip_r0) || (Xx_Pix_height - 1 - y > Clip_r1)) return n ;
+  if (x0 < Clip_c0) x0 = Clip_c0 ;
+  if (x1 > Clip_c1) x1 = Clip_c1 ;
+  if (x0 > x1) return n ;
+
+  rect[n].x = x0 ;
+  rect[n].y = Xx_Pix_height - 1 - y ;
+  rect[n].width = x1 - x0 + 1 ;
+  rect[n].height = 1 ;
+  n++ ;
+  if (n == XX_BATCH) {
+    XFillRectangles(XxDisplay, XxDrawable, XxPixmapContext, rect, n) ;
+    n = 0 ;
+  }
+  return n ;
+}
 
-     int len;
 
-     len = strlen((const char *)s);
 
-     XDrawString(XxDisplay,XxDrawable,XxPixmapContext,
-                                         x,Xx_Pix_height-1-y,
-                                         (char *)s, len);
+static void Xx_Ellipse_Span (int x0, int x1, int row, void *ctx)
+{
+  Xx_Batch *b = (Xx_Batch *)ctx ;
 
-  return 1 ;     
+  b->n = Xx_Add_Run (b->rect, b->n, x0, x1, Xx_Pix_height - 1 - row) ;
 }
 
 
 
-
-int Get_Current_Dimensions_X (int dimensions[2])
+static int Xx_Ellipse (double Da, double Db, double Drx, double Dry, int fill)
+// Ellipse_X and Fill_Ellipse_X : the runs of Ellipse_Spans sent as
+// rectangles, XX_BATCH to a request
 {
-  dimensions[0] = Xx_Pix_width ;
-  dimensions[1] = Xx_Pix_height ;
-  return 1 ;  
+  XRectangle rect[XX_BATCH] ;
+  Xx_Batch b ;
+  int s ;
+
+  b.rect = rect ;
+  b.n = 0 ;
+  s = Ellipse_Spans (Da, Db, Drx, Dry, fill, Xx_Ellipse_Span, &b) ;
+  if (b.n > 0) XFillRectangles(XxDisplay, XxDrawable, XxPixmapContext, rect, b.n) ;
+
+  return s ;
 }
 
 
-int Get_Current_Dimensions_DX (double dimensions[2]) 
+
+int Ellipse_X (double Da, double Db, double Drx, double Dry)
 {
-  dimensions[0] = Xx_Pix_width ;
-  dimensions[1] = Xx_Pix_height ;
-  return 1 ;  
+  if (Current_Pen_Width > 1) {
+    // the server strokes the arc with the GC's line width
+    double a = trunc(Da) ;
+    double cb = Xx_Pix_height - 1 - trunc(Db) ;
+    double rx = trunc(Drx) + ceil(Current_Pen_Width) ;
+    double ry = trunc(Dry) + ceil(Current_Pen_Width) ;
+    if ((Clip_c0 > Clip_c1) || (a + rx < Clip_c0) || (a - rx > Clip_c1) ||
+        (cb + ry < Clip_r0) || (cb - ry > Clip_r1)) return 1 ;
+    XDrawArc(XxDisplay, XxDrawable, XxPixmapContext,
+             (int)Da - (int)Drx, Xx_Pix_height - 1 - (int)Db - (int)Dry,
+             2*(int)Drx, 2*(int)Dry, 0, 360*64) ;
+    return 1 ;
+  }
+
+  return Xx_Ellipse (Da, Db, Drx, Dry, 0) ;
 }
 
 
-int Change_Pen_Dimensions_X (double Dw, double Dh)
+
+int Fill_Ellipse_X (double Da, double Db, double Drx, double Dry)
 {
-  printf("Change_Pen_Dimensions_X  not implemented\n") ;
-  return 0 ;
+  return Xx_Ellipse (Da, Db, Drx, Dry, 1) ;
 }
 
 
 
-int Draw_Text_X (
-               int num_lines_of_text,
-               const void *lines_of_text, // an array of pointers
-               double startx, 
-               double starty,
-               double height,
-               double x_over_y_ratio,
-               double extra_space_between_letters_fraction,
-               double extra_space_between_lines_fraction) 
+int Fill_Prepared_Polygon_X (G_Prepared_Polygon *p, double Ddx, double Ddy)
+// The rounded vertices as one XFillPolygon request, which the
+// server fills with the same even-odd rule as the rectangles ;
+// with CoordModePrevious only the first point moves.  Unless the
+// polygon is nearly a rectangle they are far fewer bytes than the
+// rectangles.  When the moved points don't fit in shorts or in one
+// request, the rectangles are sent instead, clipped here since
+// XRectangle holds shorts (and to skip the ones the clip rectangle
+// would drop).
 {
-  printf("Draw_Text_X  not implemented\n") ;
-  return 0 ;
+  XRectangle rect[XX_BATCH] ;
+  long max ;
+  int dx, dy, k, n, x0, x1, r0, r1 ;
+  int *q ;
+
+  if (p == NULL) return 0 ;
+  dx = (int)floor(Ddx + 0.5) ;
+  dy = Xx_Pix_height - 1 - (int)floor(Ddy + 0.5) ;
+
+  if (Clip_Out (p->x0 + dx, p->top0 + dy, p->x1 + dx, p->top1 + dy)) return 1 ;
+
+  max = XExtendedMaxRequestSize(XxDisplay) ;
+  if (max == 0) max = XMaxRequestSize(XxDisplay) ;
+  if ((p->xp != NULL) && (p->n + 4 <= max) && // 4 words of header, 1 per point
+      (p->vx0 + dx >= SHRT_MIN) && (p->vx1 + dx <= SHRT_MAX) &&
+      (p->vtop0 + dy >= SHRT_MIN) && (p->vtop1 + dy <= SHRT_MAX)) {
+    p->xp[0].x = (int)floor(p->x[0]) + dx ;
+    p->xp[0].y = (int)floor(-p->y[0]) + dy ;
+    XFillPolygon(XxDisplay, XxDrawable, XxPixmapContext,
+                 p->xp, p->n, Nonconvex, CoordModePrevious) ;
+    return 1 ;
+  }
+
+  n = 0 ;
+  for (k = 0, q = p->rect ; k < p->nrect ; k++, q += 4) {
+    x0 = q[0] + dx ; x1 = x0 + q[2] - 1 ;
+    r0 = q[1] + dy ; r1 = r0 + q[3] - 1 ;
+    if (x0 < Clip_c0) x0 = Clip_c0 ;
+    if (x1 > Clip_c1) x1 = Clip_c1 ;
+    if (r0 < Clip_r0) r0 = Clip_r0 ;
+    if (r1 > Clip_r1) r1 = Clip_r1 ;
+    if ((x0 > x1) || (r0 > r1)) continue ;
+    rect[n].x = x0 ;
+    rect[n].y = r0 ;
+    rect[n].width = x1 - x0 + 1 ;
+    rect[n].height = r1 - r0 + 1 ;
+    n++ ;
+    if (n == XX_BATCH) {
+      XFillRectangles(XxDisplay, XxDrawable, XxPixmapContext, rect, n) ;
+      n = 0 ;
+    }
+  }
+  if (n > 0) XFillRectangles(XxDisplay, XxDrawable, XxPixmapContext, rect, n) ;
+
+  return 1 ;
 }
 
 
 
-/////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////
 
 
-void fputintB (int x, FILE *fp)
+#define SECTOR_MAX_STEPS 996 // so that the points fit the 1000 of the polygons
+
+static int sector(double xcenter, double ycenter, double radius, 
+                  double start_radians, double end_radians,
+                  double *x, double *y)
+// The points of the arc from start to end, then the center ; at most
+// SECTOR_MAX_STEPS + 2 of them.  The steps are as long as keeps the
+// chords within 1/4 pixel of the circle, so a small sector gets only
+// a few, and each point is the one before turned by the step, which
+// needs one cos and sin for the whole arc.
+// return the number of points, or 0 if the angles make no sector
 {
-   char *p ;
-   int c[4],i ;
+  int num,j ;
+  double delta,step,c,s,dx,dy,t ;
 
-   p = (char *) &x ;
+  delta = end_radians - start_radians ;
+  if (delta < 0) return 0 ;
+  if (delta > 2*M_PI) return 0 ;
 
-   for (i = 0 ; i < 4 ; i++) {
-        c[i] = *p ;
-        p++ ;
-   }
+  t = fabs(radius) ;
+  step = (t > 0.25) ? 2*acos(1 - 0.25/t) : delta ;
+  if (delta == 0) num = 1 ;
+  else if (delta >= step*SECTOR_MAX_STEPS) num = SECTOR_MAX_STEPS ;
+  else num = (int)ceil(delta/step) ;
+
+  c = cos(delta/num) ;
+  s = sin(delta/num) ;
+  dx = radius*cos(start_radians) ;
+  dy = radius*sin(start_radians) ;
+  for (j = 0 ; j < num ; j++) {
+    x[j] = xcenter + dx ;
+    y[j] = ycenter + dy ;
+    t = dx*c - dy*s ;
+    dy = dx*s + dy*c ;
+    dx = t ;
+  }
 
-   for (i = 3 ; i >= 0 ; i--) {
-        fputc(c[i], fp) ;
-   }
+  // the end is placed exactly, so that sectors sharing it meet
+  x[num] = xcenter + radius*cos(end_radians) ;
+  y[num] = ycenter + radius*sin(end_radians) ;
+  x[num+1] = xcenter ;
+  y[num+1] = ycenter ;
 
+  return num + 2 ;
 }
 
 
 
-
-int fgetintB (FILE *fp)
+int Fill_Sector_X (double Da, double Db, double Dr,
+                   double start_radians, double end_radians)
+// one pie slice arc request ; X measures angles in 64ths of a degree
 {
-   char *p ;
-   int c[4],i ;
-   int x ;
-   char q ;
+  int a = (int)Da ;
+  int b = (int)Db ;
+  int r = (int)Dr ;
+  int a0, a1 ;
+  double delta = end_radians - start_radians ;
 
-   for (i = 3 ; i >= 0 ; i--) {
-        c[i] = fgetc(fp) ;
-   }
+  if ((delta < 0) || (delta > 2*M_PI)) { printf("Sector flaw\n") ; return 1 ; }
 
+  a0 = (int)floor(start_radians*(180*64/M_PI) + 0.5) ;
+  a1 = (int)floor(end_radians*(180*64/M_PI) + 0.5) ;
+  if (Clip_Out (a - r, Xx_Pix_height - 1 - b - r, a + r, Xx_Pix_height - 1 - b + r)) return 1 ;
+  XFillArc(XxDisplay, XxDrawable, XxPixmapContext,
+           a - r, Xx_Pix_height - 1 - b - r, 2*r, 2*r, a0, a1 - a0) ;
 
+  return 1 ;
+}
 
-   p = (char *) &x ;
 
-   for (i = 0 ; i < 4 ; i++) {
-        q = c[i] ;
-        *p = q ;;
-        p++ ;
-   }
 
-   return x ;
-}
 
 
+int Font_Pixel_Height_X ()
+// Returns the height of the font in pixels. 
+{
+     if (XxFontInfo == NULL) return FONT_HEIGHT ;
+     return XxFontInfo->max_bounds.ascent + XxFontInfo->max_bounds.descent;
+}
 
 
 
+// the void * delcarations below allow for the passing of
+// arrays of characters (usual usage) but also, for instance,
+// an array of doubles that is composed of packed characters
 
 
-void  XImage_To_XWD_File (XImage *pxim,  FILE *fp)
+static XCharStruct *Xx_Char_Info (XFontStruct *f, unsigned int c, XCharStruct *def)
+// the metrics XTextWidth takes for the byte c in the single row
+// font f : def if f does not have it
 {
-  // assumes full color but uses full 32 bits per pixel
- int header_size, file_version, format, depth ;
- int xoffset, byte_order, bitmap_unit, bitmap_order, bitmap_pad ;
- int bits_per_pixel, bytes_per_line, visual_class ;
- int redmask, greenmask, bluemask ;
- int bitsperrgb, numentriesincolormap, numcolorstructures ;
- int windowwidth, windowheight, windowx, windowy, windowborderwidth ;
- int numbytestowrite ;
- int width,height ;
+  XCharStruct *cs ;
+
+  if ((c < f->min_char_or_byte2) || (c > f->max_char_or_byte2)) return def ;
+  if (f->per_char == NULL) return &f->min_bounds ;
+  cs = &f->per_char[c - f->min_char_or_byte2] ;
+  if ((cs->width == 0) &&
+      ((cs->rbearing | cs->lbearing | cs->ascent | cs->descent) == 0)) return def ;
+  return cs ;
+}
 
- header_size = 104 ;
- fputintB(header_size,fp) ;
 
- file_version = 7 ;
- fputintB(file_version,fp) ; 
 
- format = 2 ; // ZPixmap
- fputintB(format,fp) ;
+static int Xx_Advances ()
+// Xx_Advance (or Xx_Advance_Fixed) for XxFontInfo, made again only
+// when the font changes ; return 0 if the font has more than one row
+// of characters
+{
+  XCharStruct *def, *cs ;
+  int c ;
+
+  if (XxFontInfo == Xx_Advance_Font) return Xx_Advance_Ok ;
+
+  Xx_Advance_Font = XxFontInfo ;
+  Xx_Advance_Ok = (XxFontInfo->max_byte1 == 0) ;
+  if (!Xx_Advance_Ok) return 0 ;
+  def = Xx_Char_Info (XxFontInfo, XxFontInfo->default_char, NULL) ;
+  Xx_Advance_Fixed = -1 ;
+  if ((def != NULL) && (XxFontInfo->min_bounds.width == XxFontInfo->max_bounds.width)) {
+    // XTextWidth too then counts every byte at that width
+    Xx_Advance_Fixed = XxFontInfo->min_bounds.width ;
+    return 1 ;
+  }
+  for (c = 0 ; c < 256 ; c++) {
+    cs = Xx_Char_Info (XxFontInfo, c, def) ;
+    Xx_Advance[c] = (cs == NULL) ? 0 : cs->width ;
+  }
+  return 1 ;
+}
 
- depth = 24 ;
- fputintB(depth,fp) ;
 
- width = pxim->width ;
- fputintB(width,fp) ;
 
- height = pxim->height ;
- fputintB(height,fp) ;
+int String_Pixel_Width_X (const void *s)
+// Returns the length, in pixels, of the string s ; the sum of
+// the widths of its characters, as XTextWidth would add them
+{
+     const unsigned char *p = (const unsigned char *)s ;
+     int w ;
 
- xoffset = 0 ;
- fputintB(xoffset,fp) ;
+     if (XxFontInfo == NULL) return FONT_WIDTH * (int)strlen((char *)s) ;
+     if (!Xx_Advances ()) return XTextWidth(XxFontInfo, (char *)s, strlen((char *)s)) ;
+     if (Xx_Advance_Fixed >= 0) return Xx_Advance_Fixed * (int)strlen((char *)s) ;
 
- byte_order = 0 ;
- fputintB(byte_order,fp) ;
+     for (w = 0 ; *p ; p++) w += Xx_Advance[*p] ;
+     return w ;
+}
 
- bitmap_unit = 32 ;
- fputintB(bitmap_unit,fp) ;
 
- bitmap_order = 0 ;
+
+int String_Pixel_Widths_X (int n, const void *strings, int *widths)
+{
+  const char **s = (const char **)strings ;
+  int k ;
+
+  if (n < 0) return 0 ;
+  for (k = 0 ; k < n ; k++) widths[k] = String_Pixel_Width_X (s[k]) ;
+  return 1 ;
+}
+
+
+
+
+
+static int Xx_Glyph (XRectangle *rect, int n, const short *q, int nq, int x, int top)
+// the nq rectangles q of a glyph whose cell's top left corner is at
+// column x, row top, clipped as in Xx_Add_Run ; a full batch is sent.
+// return the new count
+{
+  int k, x0, x1, r0, r1 ;
+
+  for (k = 0 ; k < nq ; k++, q += 4) {
+    x0 = x + q[0] ; x1 = x0 + q[2] - 1 ;
+    r0 = top + q[1] ; r1 = r0 + q[3] - 1 ;
+    if (x0 < Clip_c0) x0 = Clip_c0 ;
+    if (x1 > Clip_c1) x1 = Clip_c1 ;
+    if (r0 < Clip_r0) r0 = Clip_r0 ;
+    if (r1 > Clip_r1) r1 = Clip_r1 ;
+    if ((x0 > x1) || (r0 > r1)) continue ;
+    rect[n].x = x0 ;
+    rect[n].y = r0 ;
+    rect[n].width = x1 - x0 + 1 ;
+    rect[n].height = r1 - r0 + 1 ;
+    n++ ;
+    if (n == XX_BATCH) {
+      XFillRectangles(XxDisplay, XxDrawable, XxPixmapContext, rect, n) ;
+      n = 0 ;
+    }
+  }
+
+  return n ;
+}
+
+
+
+static int Xx_Font_String (XRectangle *rect, int n, const char *s, int x, int top)
+// Xx_Glyph for each character of the string s, in the built in font
+// with the top left corner of the first cell at column x, row top
+{
+  int g ;
+
+  if (Font_Clip_Out (s, x, top)) return n ;
+
+  for ( ; *s && (x <= Clip_c1) ; s++, x += FONT_WIDTH) {
+    if (x + FONT_WIDTH <= Clip_c0) continue ;
+    g = (unsigned char)*s - FONT_FIRST ;
+    if ((g < 0) || (g >= FONT_GLYPHS)) continue ;
+    n = Xx_Glyph (rect, n, Font_Rect[g][0], Font_Nrect[g], x, top) ;
+  }
+
+  return n ;
+}
+
+
+
+int Draw_String_X (const void *s, double Dx, double Dy)
+// Draw the string s, with the lower left hand corner at (x,y)
+// (in the built in font if the X font could not be loaded)
+{
+  int x = (int)Dx ;
+  int y = (int)Dy ;
+
+     int len;
+
+     if (XxFontInfo == NULL) {
+       XRectangle rect[XX_BATCH] ;
+       int n = Xx_Font_String (rect, 0, (const char *)s, x, Xx_Pix_height - y - FONT_ASCENT) ;
+       if (n > 0) XFillRectangles(XxDisplay, XxDrawable, XxPixmapContext, rect, n) ;
+       return 1 ;
+     }
+
+     len = strlen((const char *)s);
+
+     XDrawString(XxDisplay,XxDrawable,XxPixmapContext,
+                                         x,Xx_Pix_height-1-y,
+                                         (char *)s, len);
+
+  return 1 ;     
+}
+
+
+
+int Draw_Strings_X (int n, const void *strings, double *Dx, double *Dy)
+// the built in font puts the glyphs of all the strings together
+// into XFillRectangles requests of XX_BATCH
+{
+  const char **s = (const char **)strings ;
+  XRectangle rect[XX_BATCH] ;
+  int k, m ;
+
+  if (n < 0) return 0 ;
+
+  if (XxFontInfo != NULL) {
+    for (k = 0 ; k < n ; k++) Draw_String_X (s[k], Dx[k], Dy[k]) ;
+    return 1 ;
+  }
+
+  m = 0 ;
+  for (k = 0 ; k < n ; k++) {
+    m = Xx_Font_String (rect, m, s[k], (int)Dx[k], Xx_Pix_height - (int)Dy[k] - FONT_ASCENT) ;
+  }
+  if (m > 0) XFillRectangles(XxDisplay, XxDrawable, XxPixmapContext, rect, m) ;
+
+  return 1 ;
+}
+
+
+
+
+int Get_Current_Dimensions_X (int dimensions[2])
+{
+  dimensions[0] = Xx_Pix_width ;
+  dimensions[1] = Xx_Pix_height ;
+  return 1 ;  
+}
+
+
+int Get_Current_Dimensions_DX (double dimensions[2]) 
+{
+  dimensions[0] = Xx_Pix_width ;
+  dimensions[1] = Xx_Pix_height ;
+  return 1 ;  
+}
+
+
+int Antialias_X (int on)
+// the core X protocol draws aliased pixels only
+{
+  return 0 ;
+}
+
+
+
+int Change_Pen_Dimensions_X (double Dw, double Dh)
+// X pens have a single width, so only Dw is used ; 1 or less
+// selects the thin (zero width) lines, the fastest ones
+{
+  int w ;
+
+  if ((Dw < 0) || (Dh < 0)) return 0 ;
+
+  Current_Pen_Width = Dw ;
+  w = (Dw > 1) ? (int)(Dw + 0.5) : 0 ;
+  XSetLineAttributes(XxDisplay, XxPixmapContext,
+                     w, LineSolid, CapButt, Current_Pen_Join) ;
+  return 1 ;
+}
+
+
+
+int Pen_Join_X (int style)
+{
+  if ((style != G_JOIN_MITER) && (style != G_JOIN_ROUND) && (style != G_JOIN_BEVEL)) return 0 ;
+
+  Current_Pen_Join = style ;
+  return Change_Pen_Dimensions_X (Current_Pen_Width, Current_Pen_Width) ;
+}
+
+
+
+int Set_Clip_Rect_X (double Dx, double Dy, double Dw, double Dh)
+// the server clips everything drawn into the pixmap, and
+// Clip_Out lets the primitives skip what it would drop
+{
+  XRectangle r ;
+  int s ;
+
+  s = Clip_Set_Rect (Dx, Dy, Dw, Dh) ;
+  r.x = Clip_c0 ;
+  r.y = Clip_r0 ;
+  r.width = s ? Clip_c1 - Clip_c0 + 1 : 0 ;
+  r.height = s ? Clip_r1 - Clip_r0 + 1 : 0 ;
+  XSetClipRectangles(XxDisplay, XxPixmapContext, 0, 0, &r, s, YXBanded) ;
+
+  return s ;
+}
+
+
+
+int Clear_Clip_X ()
+{
+  XSetClipMask(XxDisplay, XxPixmapContext, None) ;
+  Clip_Whole_Window () ;
+  return 1 ;
+}
+
+
+
+static void Xx_Text_Glyph (const short *q, int nq, int x, int top, void *ctx)
+{
+  Xx_Batch *b = (Xx_Batch *)ctx ;
+
+  b->n = Xx_Glyph (b->rect, b->n, q, nq, x, top) ;
+}
+
+
+
+int Draw_Text_X (
+               int num_lines_of_text,
+               const void *lines_of_text, // an array of pointers
+               double startx, 
+               double starty,
+               double height,
+               double x_over_y_ratio,
+               double extra_space_between_letters_fraction,
+               double extra_space_between_lines_fraction) 
+// the glyphs of all the lines go out together, in XFillRectangles
+// requests of XX_BATCH
+{
+  XRectangle rect[XX_BATCH] ;
+  Xx_Batch b ;
+  int s ;
+
+  b.rect = rect ;
+  b.n = 0 ;
+  s = Text_Lines (num_lines_of_text, lines_of_text, startx, starty,
+                  height, x_over_y_ratio,
+                  extra_space_between_letters_fraction,
+                  extra_space_between_lines_fraction, Xx_Text_Glyph, &b) ;
+  if (b.n > 0) XFillRectangles(XxDisplay, XxDrawable, XxPixmapContext, rect, b.n) ;
+
+  return s ;
+}
+
+
+
+/////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////
+
+
+void fputintB (int x, FILE *fp)
+{
+   char *p ;
+   int c[4],i ;
+
+   p = (char *) &x ;
+
+   for (i = 0 ; i < 4 ; i++) {
+        c[i] = *p ;
+        p++ ;
+   }
+
+   for (i = 3 ; i >= 0 ; i--) {
+        fputc(c[i], fp) ;
+   }
+
+}
+
+
+
+
+int fgetintB (FILE *fp)
+{
+   char *p ;
+   int c[4],i ;
+   int x ;
+   char q ;
+
+   for (i = 3 ; i >= 0 ; i--) {
+        c[i] = fgetc(fp) ;
+   }
+
+
+
+   p = (char *) &x ;
+
+   for (i = 0 ; i < 4 ; i++) {
+        q = c[i] ;
+        *p = q ;;
+        p++ ;
+   }
+
+   return x ;
+}
+
+
+
+
+
+
+
+void  XImage_To_XWD_File (XImage *pxim,  FILE *fp)
+{
+  // assumes full color but uses full 32 bits per pixel
+ int header_size, file_version, format, depth ;
+ int xoffset, byte_order, bitmap_unit, bitmap_order, bitmap_pad ;
+ int bits_per_pixel, bytes_per_line, visual_class ;
+ int redmask, greenmask, bluemask ;
+ int bitsperrgb, numentriesincolormap, numcolorstructures ;
+ int windowwidth, windowheight, windowx, windowy, windowborderwidth ;
+ int numbytestowrite ;
+ int width,height ;
+
+ header_size = 104 ;
+ fputintB(header_size,fp) ;
+
+ file_version = 7 ;
+ fputintB(file_version,fp) ; 
+
+ format = 2 ; // ZPixmap
+ fputintB(format,fp) ;
+
+ depth = 24 ;
+ fputintB(depth,fp) ;
+
+ width = pxim->width ;
+ fputintB(width,fp) ;
+
+ height = pxim->height ;
+ fputintB(height,fp) ;
+
+ xoffset = 0 ;
+ fputintB(xoffset,fp) ;
+
+ byte_order = 0 ;
+ fputintB(byte_order,fp) ;
+
+ bitmap_unit = 32 ;
+ fputintB(bitmap_unit,fp) ;
+
+ bitmap_order = 0 ;
  fputintB(bitmap_order,fp) ;
 
  bitmap_pad = 32  ;
@@ -1706,6 +3016,8 @@ int Set_Color_Rgb_X (int r, int g, int b)
   Current_Red_Int   = r ;
   Current_Green_Int = g ;
   Current_Blue_Int  = b ;
+  Current_Alpha_Int = 255 ;
+  Current_Alpha_Weight = 256 ;
   Current_Color_Pixel = p ;
 
   return 1 ;  
@@ -1732,6 +3044,21 @@ int Set_Color_Rgb_DX (double dr, double dg, double db)
 
 
 
+int Set_Color_Rgba_X (int r, int g, int b, int a)
+// X draws opaque pixels only, so the alpha is ignored
+{
+  return Set_Color_Rgb_X (r,g,b) ;
+}
+
+
+
+int Set_Color_Rgba_DX (double dr, double dg, double db, double da)
+{
+  return Set_Color_Rgb_DX (dr,dg,db) ;
+}
+
+
+
 
 int Convert_Pixel_To_rgbI_X (int pixel, int rgbI[3]) 
 // rgbI[] values in 0-255
@@ -1755,72 +3082,3017 @@ int Convert_rgbI_To_rgb_X (int rgbI[3], double rgb[3])
   rgb[1] = rgbI[1] / 256.0 + d ;
   rgb[2] = rgbI[2] / 256.0 + d ;
 
-  return 1 ;  
+  return 1 ;  
+}
+
+
+
+int XImage_to_Display (XImage *pxim, double Dx, double Dy)
+// Put lower left corner of file into the graphics window at (x,y).
+// return 1 if successful else 0
+{
+  int x = (int)Dx ;
+  int y = (int)Dy ;
+
+  int image_width, image_height ;
+  int srcx,srcy,destx,desty ;
+  int transfer_width, transfer_height ;
+
+  image_width = pxim->width ;
+  image_height = pxim->height ;
+  //  printf("%d %d\n",image_width,image_height) ;
+
+  if (image_height <= Xx_Pix_height - y) {
+
+    transfer_height = image_height ;
+    srcx = 0 ;
+    srcy = 0 ;
+    destx = x ;
+    desty = Xx_Pix_height - y - image_height ;
+    if (image_width <= Xx_Pix_width - x) { transfer_width = image_width ; }
+    else { transfer_width = Xx_Pix_width - x ;}
+
+  } else {
+
+    transfer_height = Xx_Pix_height - y ;
+    srcx = 0 ;
+    srcy = image_height - (Xx_Pix_height - y) ;
+    destx = x ;
+    desty = 0 ;
+    if (image_width <= Xx_Pix_width - x) { transfer_width = image_width ; }
+    else { transfer_width = Xx_Pix_width - x ;}
+
+  }
+
+
+  XPutImage (XxDisplay, XxDrawable, XxPixmapContext, pxim,
+             srcx, srcy, destx, desty,
+             transfer_width, transfer_height) ;
+	     //	     Xx_Pix_width, Xx_Pix_height) ;
+
+  return 1 ;
+}
+
+
+
+XImagePointer Get_ximage_of_display()
+// should be used with caution...
+// XImage pxim = Get_ximage_of_display() ;
+// later on, should do
+// XDestroyImage(pxim) 
+// when done with ximage or could create memory leak
+{
+  XImage *pxim ;
+
+  pxim = XGetImage (XxDisplay, XxDrawable, 0,0, Xx_Pix_width, Xx_Pix_height,
+                      AllPlanes, ZPixmap) ;
+
+  return pxim ;
+}
+
+
+
+
+
+
+//====================================================================
+// Memory stuff :
+//
+// A headless backend that draws straight into a 32 bit 0x00RRGGBB
+// frame buffer in main memory, with no X server involved.
+// Select it with G_init_graphics_memory (w,h) instead of G_init_graphics.
+// Rows are stored top down, exactly like a 32 bit ZPixmap XImage,
+// so the XWD and BMP savers work on it unchanged.
+// Xx_Pix_width and Xx_Pix_height describe its size, as for X.
+
+
+static unsigned int *Mm_Buffer = NULL ;
+static XImage Mm_Image ; // describes Mm_Buffer to the XImage based code
+
+#define MM_PIXEL(x,row)  Mm_Buffer[(row)*Xx_Pix_width + (x)]
+// (x,row) are device coordinates, row = Xx_Pix_height - 1 - y
+
+
+// The depth buffer used by the _3d fills : one float per pixel,
+// smaller is nearer.  It is split into MM_ZTILE x MM_ZTILE tiles,
+// each with an upper bound on the depths stored in it, so a
+// triangle lying behind everything in a tile skips the whole tile.
+// Clearing only resets the tile records ; a tile's depths are
+// rewritten the first time something is drawn into it.  The X
+// backend allocates it on its first _3d fill.
+
+static float *Mm_Zbuffer = NULL ;
+static float *Mm_Ztile_max = NULL ;        // upper bound of each tile's depths
+static unsigned char *Mm_Ztile_stale = NULL ; // 1 until the tile is first touched
+static int Mm_Ztiles_wide ;
+static int Mm_Ztiles_high ;
+
+#define MM_ZTILE_BITS 3
+#define MM_ZTILE (1 << MM_ZTILE_BITS)
+#define MM_ZFAR 3.0e38f // the depth of an empty pixel
+#define MM_DEPTH(x,row)  Mm_Zbuffer[(row)*Xx_Pix_width + (x)]
+
+int Set_Color_Rgb_M (int r, int g, int b) ;
+int Clear_Buffer_M () ;
+int Close_Down_M () ;
+static int Mm_Stroke (double *x, double *y, int npts, int closed) ;
+
+
+
+static int Mm_Alloc_Depth (int swidth, int sheight)
+// a cleared depth buffer for a swidth x sheight window
+// return 0 if out of memory, else 1
+{
+    Mm_Ztiles_wide = (swidth + MM_ZTILE - 1) >> MM_ZTILE_BITS ;
+    Mm_Ztiles_high = (sheight + MM_ZTILE - 1) >> MM_ZTILE_BITS ;
+    Mm_Zbuffer = (float *) malloc((size_t)swidth * sheight * sizeof(float)) ;
+    Mm_Ztile_max = (float *) malloc((size_t)Mm_Ztiles_wide * Mm_Ztiles_high * sizeof(float)) ;
+    Mm_Ztile_stale = (unsigned char *) malloc((size_t)Mm_Ztiles_wide * Mm_Ztiles_high) ;
+    if ((Mm_Zbuffer == NULL) || (Mm_Ztile_max == NULL) || (Mm_Ztile_stale == NULL)) {
+      Mm_Free_Depth() ;
+      return 0 ;
+    }
+    Mm_Clear_Depth() ;
+    return 1 ;
+}
+
+
+
+static void Mm_Free_Depth ()
+{
+    free(Mm_Zbuffer) ;
+    free(Mm_Ztile_max) ;
+    free(Mm_Ztile_stale) ;
+    Mm_Zbuffer = NULL ;
+    Mm_Ztile_max = NULL ;
+    Mm_Ztile_stale = NULL ;
+}
+
+
+
+int Init_M (double Dswidth, double Dsheight)
+{
+    int swidth = (int)Dswidth ;
+    int sheight = (int)Dsheight ;
+
+    if ((swidth <= 0) || (sheight <= 0)) return 0 ;
+
+    Mm_Buffer = (unsigned int *) malloc((size_t)swidth * sheight * sizeof(unsigned int)) ;
+    if (Mm_Buffer == NULL) {
+      printf("Init_M : can't allocate a %d x %d frame buffer\n",swidth,sheight) ;
+      return 0 ;
+    }
+
+    if (!Mm_Alloc_Depth (swidth, sheight)) {
+      printf("Init_M : can't allocate a %d x %d depth buffer\n",swidth,sheight) ;
+      Close_Down_M() ;
+      return 0 ;
+    }
+
+    Xx_Pix_width = swidth ;
+    Xx_Pix_height = sheight ;
+    Xx_Win_width = swidth ;
+    Xx_Win_height = sheight ;
+
+    memset(&Mm_Image, 0, sizeof(Mm_Image)) ;
+    Mm_Image.width = swidth ;
+    Mm_Image.height = sheight ;
+    Mm_Image.xoffset = 0 ;
+    Mm_Image.format = ZPixmap ;
+    Mm_Image.data = (char *)Mm_Buffer ;
+    Mm_Image.byte_order = LSBFirst ;
+    Mm_Image.bitmap_unit = 32 ;
+    Mm_Image.bitmap_bit_order = LSBFirst ;
+    Mm_Image.bitmap_pad = 32 ;
+    Mm_Image.depth = 24 ;
+    Mm_Image.bytes_per_line = 4 * swidth ;
+    Mm_Image.bits_per_pixel = 32 ;
+    Mm_Image.red_mask = 0x00ff0000 ;
+    Mm_Image.green_mask = 0x0000ff00 ;
+    Mm_Image.blue_mask = 0x000000ff ;
+    XInitImage (&Mm_Image) ; // no display needed, this just fills in the access functions
+
+    Clip_Whole_Window () ;
+
+    // same white paper and black pencil as Init_X
+    Set_Color_Rgb_M (255,255,255) ;
+    Clear_Buffer_M() ;
+    Set_Color_Rgb_M (0,0,0) ;
+
+    return 1 ;
+}
+
+
+
+int Close_Down_M()
+{
+    free(Mm_Buffer) ;
+    Mm_Buffer = NULL ;
+    Mm_Free_Depth() ;
+    return 1 ;
+}
+
+
+
+int Copy_Buffer_And_Flush_M()
+// nothing to show ... the buffer IS the image
+{
+   return 1 ;
+}
+
+
+
+int Get_Events_M (int *d)
+// there is no input device, so there is never an event
+{
+  d[0] = 0 ;
+  d[1] = 0 ;
+  return -3000 ;
+}
+
+
+int Get_Events_DM (double *d)
+{
+  d[0] = 0 ;
+  d[1] = 0 ;
+  return -3000 ;
+}
+
+
+
+int Set_Color_Rgb_M (int r, int g, int b)
+{
+  if (r < 0) r = 0 ; else if (r > 255) r = 255 ;
+  if (g < 0) g = 0 ; else if (g > 255) g = 255 ;
+  if (b < 0) b = 0 ; else if (b > 255) b = 255 ;
+
+  Current_Red_Int   = r ;
+  Current_Green_Int = g ;
+  Current_Blue_Int  = b ;
+  Current_Alpha_Int = 255 ;
+  Current_Alpha_Weight = 256 ;
+  Current_Color_Pixel = (r << 16) | (g  << 8) | (b) ;
+
+  return 1 ;  
+}
+
+
+
+int Set_Color_Rgb_DM (double dr, double dg, double db)
+{
+  int r,g,b ;
+
+  if (dr < 0.0) dr = 0.0 ; else if (dr > 1.0) dr = 1.0 ;
+  if (dg < 0.0) dg = 0.0 ; else if (dg > 1.0) dg = 1.0 ;
+  if (db < 0.0) db = 0.0 ; else if (db > 1.0) db = 1.0 ;
+
+  r = (int)(256*dr) ;
+  g = (int)(256*dg) ;
+  b = (int)(256*db) ;
+
+  Set_Color_Rgb_M (r,g,b) ;
+
+  return 1 ;  
+}
+
+
+
+int Set_Color_Rgba_M (int r, int g, int b, int a)
+{
+  Set_Color_Rgb_M (r,g,b) ;
+
+  if (a < 0) a = 0 ; else if (a > 255) a = 255 ;
+  Current_Alpha_Int = a ;
+  Current_Alpha_Weight = a + (a >> 7) ; // so that 255 is exactly opaque
+
+  return 1 ;  
+}
+
+
+
+int Set_Color_Rgba_DM (double dr, double dg, double db, double da)
+{
+  Set_Color_Rgb_DM (dr,dg,db) ;
+
+  if (da < 0.0) da = 0.0 ; else if (da > 1.0) da = 1.0 ;
+  Current_Alpha_Weight = (int)(256*da + 0.5) ; // a = 0.5 mixes exactly half and half
+  Current_Alpha_Int = (Current_Alpha_Weight > 255) ? 255 : Current_Alpha_Weight ;
+
+  return 1 ;  
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+// Blending : with an alpha below 255 every pixel the memory
+// backend draws is mixed into the one already there (source
+// over), src * a + dst * (1 - a) per channel, with a as a weight
+// out of 256.  Whole spans go 4 pixels at a time with SSE2.
+/////////////////////////////////////////////////////////////////
+
+
+
+static void Mm_Mix (unsigned int *p, unsigned int s, int a)
+// *p = s over *p with weight a/256, a in 0..256
+{
+  unsigned int d = *p ;
+  unsigned int b = 256 - a ;
+
+  *p = ((((s & 0xff00ff) * a + (d & 0xff00ff) * b) >> 8) & 0xff00ff)
+     | ((((s & 0x00ff00) * a + (d & 0x00ff00) * b) >> 8) & 0x00ff00) ;
+}
+
+
+
+static void Mm_Put (unsigned int *p, unsigned int s, int a)
+// a pixel of a primitive drawn with alpha weight a
+{
+  if (a >= 256) *p = s ; else Mm_Mix (p, s, a) ;
+}
+
+
+
+static void Mm_Blend (unsigned int *p, int a)
+// mix the current color into *p with coverage a/256 (antialiasing)
+// on top of the current alpha
+{
+  Mm_Mix (p, (unsigned int)Current_Color_Pixel, (a * Current_Alpha_Weight) >> 8) ;
+}
+
+
+
+#ifdef __SSE2__
+
+static __m128i Mm_Mix4 (__m128i s, __m128i d, __m128i alo, __m128i ahi)
+// Mm_Mix of 4 pixels ; alo holds the weights of pixels 0 and 1 as
+// 16 bit lanes (a0 x4, a1 x4), ahi those of pixels 2 and 3.
+// s * a + d * (256 - a) never exceeds 16 bits
+{
+  __m128i zero = _mm_setzero_si128() ;
+  __m128i k256 = _mm_set1_epi16 (256) ;
+  __m128i lo = _mm_add_epi16 (_mm_mullo_epi16 (_mm_unpacklo_epi8 (s, zero), alo),
+                              _mm_mullo_epi16 (_mm_unpacklo_epi8 (d, zero), _mm_sub_epi16 (k256, alo))) ;
+  __m128i hi = _mm_add_epi16 (_mm_mullo_epi16 (_mm_unpackhi_epi8 (s, zero), ahi),
+                              _mm_mullo_epi16 (_mm_unpackhi_epi8 (d, zero), _mm_sub_epi16 (k256, ahi))) ;
+  return _mm_packus_epi16 (_mm_srli_epi16 (lo, 8), _mm_srli_epi16 (hi, 8)) ;
+}
+
+#endif
+
+
+
+static void Mm_Blend_Span (unsigned int *p, int n, int a)
+// the current color over p[0..n-1] with weight a/256
+{
+  unsigned int c = (unsigned int)Current_Color_Pixel ;
+  int i = 0 ;
+
+#ifdef __SSE2__
+  __m128i s = _mm_set1_epi32 ((int)c) ;
+  __m128i w = _mm_set1_epi16 ((short)a) ;
+  for ( ; i + 4 <= n ; i += 4) {
+    _mm_storeu_si128 ((__m128i *)(p + i), Mm_Mix4 (s, _mm_loadu_si128 ((__m128i *)(p + i)), w, w)) ;
+  }
+#endif
+
+  for ( ; i < n ; i++) Mm_Mix (p + i, c, a) ;
+}
+
+
+
+static void Mm_Span (int x0, int x1, int row)
+// fill device pixels x0..x1 of one row ... the caller has clipped
+// to the window, the clip rectangle is applied here
+{
+  unsigned int *p, *e ;
+  unsigned int c = (unsigned int)Current_Color_Pixel ;
+
+  if ((row < Clip_r0) || (row > Clip_r1)) return ;
+  if (x0 < Clip_c0) x0 = Clip_c0 ;
+  if (x1 > Clip_c1) x1 = Clip_c1 ;
+  if (x0 > x1) return ;
+  p = &MM_PIXEL(x0,row) ;
+  e = p + (x1 - x0) ;
+
+  if (Current_Alpha_Weight < 256) { Mm_Blend_Span (p, x1 - x0 + 1, Current_Alpha_Weight) ; return ; }
+
+  while (p <= e) *p++ = c ;
+}
+
+
+
+static void Mm_Clear_Depth ()
+// O(number of tiles), not O(number of pixels)
+{
+   int i, n = Mm_Ztiles_wide * Mm_Ztiles_high ;
+
+   if (Mm_Ztile_max == NULL) return ; // X before its first _3d fill
+   for (i = 0 ; i < n ; i++) Mm_Ztile_max[i] = MM_ZFAR ;
+   memset(Mm_Ztile_stale, 1, n) ;
+}
+
+
+
+int Clear_Buffer_M() 
+// the depth buffer is cleared along with the pixels
+{
+   int row ;
+
+   for (row = 0 ; row < Xx_Pix_height ; row++) {
+     Mm_Span (0, Xx_Pix_width - 1, row) ;
+   }
+   Last_Clear_Buffer_Pixel = Current_Color_Pixel ;
+   Mm_Clear_Depth() ;
+
+   return 1 ;
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+// Antialiased drawing for the memory backend, on while
+// Mm_Antialias is set (G_antialias).  Each pixel gets the
+// fraction of it that the shape covers, and the current color
+// is blended into it by that fraction :
+//   lines    Wu's algorithm, two pixels per step across the line
+//   circles  the same, from the exact distance to the center
+//   fills    exact area coverage of the polygon's edges, summed
+//            along each row ; filled circles from the distance
+// Lines and circles put integer coordinates at pixel centers,
+// like the aliased ones ; fills treat pixel (c,r) as the unit
+// square [c,c+1) x [r,r+1), like the aliased fills.
+/////////////////////////////////////////////////////////////////
+
+static int Mm_Antialias = 0 ;
+
+static float *Mm_Cover = NULL ;   // work area of Mm_Work, only grows
+static size_t Mm_Cover_size = 0 ;
+
+
+
+static void Mm_Blend_Coverage (unsigned int *p, const float *cov, int n)
+// Mm_Blend of p[0..n-1] with coverages cov[0..n-1] in [0,1] ;
+// with SSE2, 4 pixels at a time in 16 bit channels
+{
+  int i = 0, a ;
+  int w = Current_Alpha_Weight ;
+
+#ifdef __SSE2__
+  __m128i solid = _mm_set1_epi32 ((int)Current_Color_Pixel) ;
+  __m128 fw = _mm_set1_ps ((float)w) ;
+  __m128 c ;
+  __m128i a4, a8 ;
+
+  for ( ; i + 4 <= n ; i += 4) {
+    c = _mm_loadu_ps (cov + i) ;
+    a = _mm_movemask_ps (_mm_cmpge_ps (c, _mm_set1_ps (1.0f))) ;
+    if ((a == 0xf) && (w == 256)) { _mm_storeu_si128 ((__m128i *)(p + i), solid) ; continue ; }
+    a = _mm_movemask_ps (_mm_cmpgt_ps (c, _mm_setzero_ps())) ;
+    if (a == 0) continue ;
+
+    // spread the 4 weights over the 4 channels of their pixels
+    a4 = _mm_cvtps_epi32 (_mm_mul_ps (c, fw)) ;
+    a8 = _mm_packs_epi32 (a4, a4) ;
+    a8 = _mm_unpacklo_epi16 (a8, a8) ;
+    _mm_storeu_si128 ((__m128i *)(p + i),
+                      Mm_Mix4 (solid, _mm_loadu_si128 ((__m128i *)(p + i)),
+                               _mm_unpacklo_epi32 (a8, a8), _mm_unpackhi_epi32 (a8, a8))) ;
+  }
+#endif
+
+  for ( ; i < n ; i++) {
+    a = (int)(cov[i] * 256 + 0.5f) ;
+    if (a > 0) Mm_Blend (p + i, a) ;
+  }
+}
+
+
+
+static void Mm_Plot_AA (int x, int row, double w)
+// blend one device pixel with weight w in [0,1], if it is not clipped
+{
+  int a ;
+
+  if ((x < Clip_c0) || (row < Clip_r0) || (x > Clip_c1) || (row > Clip_r1)) return ;
+  a = (int)(w * 256 + 0.5) ;
+  if (a <= 0) return ;
+  if (a > 256) a = 256 ;
+  Mm_Blend (&MM_PIXEL(x,row), a) ;
+}
+
+
+
+static void Mm_Wu_Line (double x0, double r0, double x1, double r1)
+// Wu's line in device coordinates : for each step along the major
+// axis, the two pixels straddling the line share its intensity
+// according to their distance from it.  The ends are weighted by
+// how much of their pixel the segment reaches.
+{
+  int steep, x, xp0, xp1, fx, gx, ip, a, lo, hi, mlo, mhi, nlo, nhi, step ;
+  double t, dx, gradient, xend, yend, xgap, inter ;
+  unsigned int *p ;
+
+  // a pixel beyond the buffer can still reach into it ; the clip
+  // rectangle only limits the pixels, so the line stays the same
+  if (!Clip_Line_Liang_Barsky (&x0,&r0, &x1,&r1, -1, -1, Xx_Pix_width, Xx_Pix_height)) return ;
+
+  steep = fabs(r1 - r0) > fabs(x1 - x0) ;
+  if (steep) {
+    t = x0 ; x0 = r0 ; r0 = t ;
+    t = x1 ; x1 = r1 ; r1 = t ;
+  }
+  if (x0 > x1) {
+    t = x0 ; x0 = x1 ; x1 = t ;
+    t = r0 ; r0 = r1 ; r1 = t ;
+  }
+  dx = x1 - x0 ;
+  gradient = (dx == 0) ? 1.0 : (r1 - r0) / dx ;
+
+#define MM_WU_PLOT(a,b,w)  { if (steep) Mm_Plot_AA (b,a,w) ; else Mm_Plot_AA (a,b,w) ; }
+
+  // first end
+  xend = floor(x0 + 0.5) ;
+  yend = r0 + gradient * (xend - x0) ;
+  xgap = 1 - (x0 + 0.5 - floor(x0 + 0.5)) ;
+  xp0 = (int)xend ;
+  MM_WU_PLOT (xp0, (int)floor(yend), (1 - (yend - floor(yend))) * xgap) ;
+  MM_WU_PLOT (xp0, (int)floor(yend) + 1, (yend - floor(yend)) * xgap) ;
+  inter = yend + gradient ;
+
+  // last end
+  xend = floor(x1 + 0.5) ;
+  yend = r1 + gradient * (xend - x1) ;
+  xgap = x1 + 0.5 - floor(x1 + 0.5) ;
+  xp1 = (int)xend ;
+  if (xp1 != xp0) {
+    MM_WU_PLOT (xp1, (int)floor(yend), (1 - (yend - floor(yend))) * xgap) ;
+    MM_WU_PLOT (xp1, (int)floor(yend) + 1, (yend - floor(yend)) * xgap) ;
+  }
+
+  // the rest in 16.16 fixed point ... after the clip the minor
+  // coordinate stays above -2, so the bias keeps the shift a floor
+  fx = (int)floor(inter * 65536 + 0.5) + 0x20000 ;
+  gx = (int)floor(gradient * 65536 + 0.5) ;
+  // clip limits along the major axis and across it
+  mlo = steep ? Clip_r0 : Clip_c0 ;
+  mhi = steep ? Clip_r1 : Clip_c1 ;
+  nlo = steep ? Clip_c0 : Clip_r0 ;
+  nhi = steep ? Clip_c1 : Clip_r1 ;
+  step = steep ? 1 : Xx_Pix_width ;
+  lo = xp0 + 1 ;
+  hi = xp1 - 1 ;
+  if (lo < mlo) { fx += gx * (mlo - lo) ; lo = mlo ; }
+  if (hi > mhi) hi = mhi ;
+  for (x = lo ; x <= hi ; x++, fx += gx) {
+    ip = (fx >> 16) - 2 ;
+    a = (fx >> 8) & 0xff ;
+    if ((ip >= nlo) && (ip < nhi)) {
+      p = steep ? &MM_PIXEL(ip, x) : &MM_PIXEL(x, ip) ;
+      Mm_Blend (p, 256 - a) ;
+      Mm_Blend (p + step, a) ;
+    } else {
+      MM_WU_PLOT (x, ip, (256 - a) / 256.0) ;
+      MM_WU_PLOT (x, ip + 1, a / 256.0) ;
+    }
+  }
+
+#undef MM_WU_PLOT
+}
+
+
+
+static void Mm_Wu_Circle (double cx, double cr, double R)
+// Wu's circle about the device point (cx,cr) : columns within 45
+// degrees of vertical get two pixels from the exact row of the circle,
+// the remaining pixels come from rows, so none is blended twice
+{
+  double h = R * M_SQRT1_2 ;
+  double s, f ;
+  int c, r, k, lo, hi ;
+
+  if (R <= 0) { Mm_Plot_AA ((int)floor(cx + 0.5), (int)floor(cr + 0.5), 1) ; return ; }
+
+  lo = (int)ceil(cx - h) ;
+  hi = (int)floor(cx + h) ;
+  if (lo < Clip_c0) lo = Clip_c0 ;
+  if (hi > Clip_c1) hi = Clip_c1 ;
+  for (c = lo ; c <= hi ; c++) {
+    s = sqrt(R*R - (c - cx)*(c - cx)) ;
+    for (k = -1 ; k <= 1 ; k += 2) {
+      f = cr + k*s ;
+      Mm_Plot_AA (c, (int)floor(f), 1 - (f - floor(f))) ;
+      Mm_Plot_AA (c, (int)floor(f) + 1, f - floor(f)) ;
+    }
+  }
+
+  lo = (int)ceil(cr - h) ;
+  hi = (int)floor(cr + h) ;
+  if (lo < Clip_r0) lo = Clip_r0 ;
+  if (hi > Clip_r1) hi = Clip_r1 ;
+  for (r = lo ; r <= hi ; r++) {
+    s = sqrt(R*R - (r - cr)*(r - cr)) ;
+    for (k = -1 ; k <= 1 ; k += 2) {
+      f = cx + k*s ;
+      c = (int)floor(f) ;
+      if (fabs(c - cx) > h) Mm_Plot_AA (c, r, 1 - (f - c)) ;
+      if (fabs(c + 1 - cx) > h) Mm_Plot_AA (c + 1, r, f - c) ;
+    }
+  }
+}
+
+
+
+static void Mm_Fill_Circle_AA (double cx, double cr, double R)
+// pixels within R - 1/2 of the center are solid spans, those out to
+// R + 1/2 are blended by how far inside the circle their center is
+{
+  double dy, wo, wi, d ;
+  int r, c, lo, hi, s0, s1 ;
+
+  if (R < 0) return ;
+
+  lo = (int)ceil(cr - R - 0.5) ;
+  hi = (int)floor(cr + R + 0.5) ;
+  if (lo < Clip_r0) lo = Clip_r0 ;
+  if (hi > Clip_r1) hi = Clip_r1 ;
+
+  for (r = lo ; r <= hi ; r++) {
+    dy = r - cr ;
+    wo = (R + 0.5)*(R + 0.5) - dy*dy ;
+    if (wo < 0) continue ;
+    wo = sqrt(wo) ;
+    wi = (R - 0.5)*(R - 0.5) - dy*dy ;
+    wi = ((R > 0.5) && (wi > 0)) ? sqrt(wi) : -1 ;
+
+    // solid middle
+    s0 = (int)ceil(cx - wi) ;
+    s1 = (int)floor(cx + wi) ;
+    if (wi >= 0) {
+      int a = (s0 < 0) ? 0 : s0 ;
+      int b = (s1 >= Xx_Pix_width) ? Xx_Pix_width - 1 : s1 ;
+      if (a <= b) Mm_Span (a, b, r) ;
+    } else {
+      s0 = (int)floor(cx) + 1 ;
+      s1 = (int)floor(cx) ;
+    }
+
+    // blended rims
+    for (c = (int)ceil(cx - wo) ; c <= (int)floor(cx + wo) ; c++) {
+      if ((c >= s0) && (c <= s1)) { c = s1 ; continue ; }
+      if ((c < Clip_c0) || (c > Clip_c1)) continue ;
+      d = sqrt((c - cx)*(c - cx) + dy*dy) ;
+      Mm_Plot_AA (c, r, R + 0.5 - d) ;
+    }
+  }
+}
+
+
+
+static void Mm_Cover_Segment (float *acc, int stride, int nrows,
+                              double x0, double y0, double x1, double y1)
+// Add the signed area that the segment contributes to each cell of
+// acc (nrows rows of stride cells), with 0 <= x <= stride - 2.
+// Summing a row left to right then gives the covered fraction of
+// each pixel.  The x of each row is kept within the segment's own
+// range, so rounding cannot carry it past 0 or stride - 2.
+{
+  double dir, dxdy, x, xnext, dy, d, t, xlo, xhi ;
+  double xa, xb, xf, s, a0, a1, a2, am, xmf ;
+  int r, r0, r1, xai, xbi, i ;
+  float *line ;
+
+  if (y0 == y1) return ;
+  dir = 1 ;
+  if (y0 > y1) {
+    dir = -1 ;
+    t = x0 ; x0 = x1 ; x1 = t ;
+    t = y0 ; y0 = y1 ; y1 = t ;
+  }
+  dxdy = (x1 - x0) / (y1 - y0) ;
+  xlo = (x0 < x1) ? x0 : x1 ;
+  xhi = (x0 < x1) ? x1 : x0 ;
+
+  x = x0 ;
+  r0 = (int)floor(y0) ;
+  if (y0 < 0) {
+    x -= y0 * dxdy ;
+    if (x < xlo) x = xlo ; else if (x > xhi) x = xhi ;
+    r0 = 0 ;
+  }
+  r1 = (int)ceil(y1) ;
+  if (r1 > nrows) r1 = nrows ;
+
+  for (r = r0 ; r < r1 ; r++) {
+    line = acc + (size_t)r * stride ;
+    dy = ((r + 1 < y1) ? r + 1 : y1) - ((r > y0) ? r : y0) ;
+    xnext = x + dxdy * dy ;
+    if (xnext < xlo) xnext = xlo ; else if (xnext > xhi) xnext = xhi ;
+    d = dy * dir ;
+    if (x < xnext) { xa = x ; xb = xnext ; } else { xa = xnext ; xb = x ; }
+    xai = (int)floor(xa) ;
+    xbi = (int)ceil(xb) ;
+
+    if (xbi <= xai + 1) {
+      // within one pixel column
+      xmf = 0.5 * (x + xnext) - xai ;
+      line[xai] += (float)(d - d * xmf) ;
+      line[xai+1] += (float)(d * xmf) ;
+    } else {
+      s = 1 / (xb - xa) ;
+      xf = xa - xai ;
+      a0 = 0.5 * s * (1 - xf) * (1 - xf) ;
+      xf = xb - xbi + 1 ;
+      am = 0.5 * s * xf * xf ;
+      line[xai] += (float)(d * a0) ;
+      if (xbi == xai + 2) {
+        line[xai+1] += (float)(d * (1 - a0 - am)) ;
+      } else {
+        a1 = s * (1.5 - (xa - xai)) ;
+        line[xai+1] += (float)(d * (a1 - a0)) ;
+        for (i = xai + 2 ; i < xbi - 1 ; i++) line[i] += (float)(d * s) ;
+        a2 = a1 + (xbi - xai - 3) * s ;
+        line[xbi-1] += (float)(d * (1 - a2 - am)) ;
+      }
+      line[xbi] += (float)(d * am) ;
+    }
+    x = xnext ;
+  }
+}
+
+
+
+static void Mm_Cover_Edge (float *acc, int stride, int nrows, double w,
+                           double x0, double y0, double x1, double y1)
+// Mm_Cover_Segment for any segment : the parts left of 0 or right of w
+// are moved onto those lines, which leaves the coverage inside unchanged
+{
+  double b, ym ;
+  int k ;
+
+  for (k = 0 ; k < 2 ; k++) {
+    b = (k == 0) ? 0 : w ;
+    if (((x0 < b) && (x1 > b)) || ((x0 > b) && (x1 < b))) {
+      ym = y0 + (y1 - y0) * (b - x0) / (x1 - x0) ;
+      Mm_Cover_Edge (acc, stride, nrows, w, x0, y0, b, ym) ;
+      Mm_Cover_Edge (acc, stride, nrows, w, b, ym, x1, y1) ;
+      return ;
+    }
+  }
+
+  if (x0 < 0) x0 = 0 ; else if (x0 > w) x0 = w ;
+  if (x1 < 0) x1 = 0 ; else if (x1 > w) x1 = w ;
+  Mm_Cover_Segment (acc, stride, nrows, x0, y0, x1, y1) ;
+}
+
+
+
+static float *Mm_Work (size_t n)
+// n zeroed floats of the shared work area, or NULL if it could not grow
+{
+  if (n > Mm_Cover_size) {
+    free(Mm_Cover) ;
+    Mm_Cover = (float *) malloc(n * sizeof(float)) ;
+    if (Mm_Cover == NULL) { Mm_Cover_size = 0 ; return NULL ; }
+    Mm_Cover_size = n ;
+  }
+  memset(Mm_Cover, 0, n * sizeof(float)) ;
+  return Mm_Cover ;
+}
+
+
+
+// The edges of the shape being filled, directed, in continuous
+// device coordinates.  Strokes are built here piece by piece.
+typedef struct {
+  double x0, r0, x1, r1 ;
+} Mm_Seg ;
+
+static Mm_Seg *Mm_Segs = NULL ; // only grows
+static int Mm_Segs_size = 0 ;
+static int Mm_Nsegs = 0 ;
+static int Mm_Segs_failed = 0 ; // an edge was lost for lack of memory
+
+
+
+static void Mm_Add_Seg (double x0, double r0, double x1, double r1)
+// horizontal edges cross no row, so they are left out
+{
+  Mm_Seg *p ;
+  int size ;
+
+  if (r0 == r1) return ;
+  if (Mm_Nsegs == Mm_Segs_size) {
+    size = (Mm_Segs_size == 0) ? 256 : 2 * Mm_Segs_size ;
+    p = (Mm_Seg *) realloc(Mm_Segs, size * sizeof(Mm_Seg)) ;
+    if (p == NULL) { Mm_Segs_failed = 1 ; return ; }
+    Mm_Segs = p ;
+    Mm_Segs_size = size ;
+  }
+  p = &Mm_Segs[Mm_Nsegs++] ;
+  p->x0 = x0 ; p->r0 = r0 ; p->x1 = x1 ; p->r1 = r1 ;
+}
+
+
+
+static int Mm_Cover_Segs (int nonzero)
+// Antialiased fill of the edges in Mm_Segs.  Every edge adds its
+// exact area coverage to a work area the size of their bounding box
+// (clipped to the clip rectangle) ; then each row is summed and blended with
+// Mm_Blend_Coverage.  nonzero = 0 is the even-odd rule : where the
+// shape overlaps itself the coverage folds back, and only pixels
+// right at a crossing are approximate.  nonzero = 1 counts any
+// winding as inside, for strokes built of overlapping pieces.
+// return 0 if the work area could not be allocated, else 1
+{
+  double xlo, xhi, rlo, rhi, a ;
+  int bx0, bx1, br0, br1, bw, bh, stride, k, r, c ;
+  float *line, *acc, sum ;
+  Mm_Seg *e ;
+
+  if (Mm_Nsegs == 0) return 1 ;
+
+  xlo = xhi = Mm_Segs[0].x0 ; rlo = rhi = Mm_Segs[0].r0 ;
+  for (k = 0 ; k < Mm_Nsegs ; k++) {
+    e = &Mm_Segs[k] ;
+    if (e->x0 < xlo) xlo = e->x0 ; else if (e->x0 > xhi) xhi = e->x0 ;
+    if (e->x1 < xlo) xlo = e->x1 ; else if (e->x1 > xhi) xhi = e->x1 ;
+    if (e->r0 < rlo) rlo = e->r0 ; else if (e->r0 > rhi) rhi = e->r0 ;
+    if (e->r1 < rlo) rlo = e->r1 ; else if (e->r1 > rhi) rhi = e->r1 ;
+  }
+  if ((Clip_c0 > Clip_c1) || (xhi <= Clip_c0) || (rhi <= Clip_r0) ||
+      (xlo >= Clip_c1 + 1) || (rlo >= Clip_r1 + 1)) return 1 ;
+  bx0 = (xlo < Clip_c0) ? Clip_c0 : (int)floor(xlo) ;
+  br0 = (rlo < Clip_r0) ? Clip_r0 : (int)floor(rlo) ;
+  bx1 = (xhi > Clip_c1 + 1) ? Clip_c1 + 1 : (int)ceil(xhi) ;
+  br1 = (rhi > Clip_r1 + 1) ? Clip_r1 + 1 : (int)ceil(rhi) ;
+  bw = bx1 - bx0 ;
+  bh = br1 - br0 ;
+  if ((bw <= 0) || (bh <= 0)) return 1 ;
+  stride = bw + 2 ;
+
+  acc = Mm_Work ((size_t)stride * bh) ;
+  if (acc == NULL) return 0 ;
+
+  for (k = 0 ; k < Mm_Nsegs ; k++) {
+    e = &Mm_Segs[k] ;
+    Mm_Cover_Edge (acc, stride, bh, bw,
+                   e->x0 - bx0, e->r0 - br0, e->x1 - bx0, e->r1 - br0) ;
+  }
+
+  for (r = 0 ; r < bh ; r++) {
+    line = acc + (size_t)r * stride ;
+    sum = 0 ;
+    for (c = 0 ; c < bw ; c++) {
+      sum += line[c] ;
+      a = fabsf(sum) ;
+      if (a > 1) {
+        if (nonzero) a = 1 ;
+        else {
+          // fold the winding sum : 0 -> 0, 1 -> 1, 2 -> 0, ...
+          a -= 2 * floor(a * 0.5) ;
+          if (a > 1) a = 2 - a ;
+        }
+      }
+      line[c] = (float)a ;
+    }
+    Mm_Blend_Coverage (&MM_PIXEL(bx0, br0 + r), line, bw) ;
+  }
+
+  return 1 ;
+}
+
+
+
+static int Mm_Cover_Polygon (double *x, double *row, int npts)
+// Antialiased even-odd fill in continuous device coordinates,
+// with Mm_Cover_Segs.
+// return 0 if the work area could not be allocated, else 1
+{
+  int k, j ;
+
+  if (npts < 3) return 1 ;
+
+  Mm_Nsegs = 0 ;
+  Mm_Segs_failed = 0 ;
+  for (k = 0 ; k < npts ; k++) {
+    j = (k + 1 < npts) ? k + 1 : 0 ;
+    Mm_Add_Seg (x[k], row[k], x[j], row[j]) ;
+  }
+  if (Mm_Segs_failed) return 0 ;
+
+  return Mm_Cover_Segs (0) ;
+}
+
+
+
+int Safe_Point_M (double Dx, double Dy)
+{
+  int x = (int)Dx ;
+  int y = (int)Dy ;
+
+    if ((x < Clip_c0) || (x > Clip_c1) ||
+        (Xx_Pix_height - 1 - y < Clip_r0) || (Xx_Pix_height - 1 - y > Clip_r1)) {return 0 ;}
+    Mm_Put (&MM_PIXEL(x, Xx_Pix_height - 1 - y), (unsigned int)Current_Color_Pixel, Current_Alpha_Weight) ;
+    return 1 ;
+}
+
+
+
+int Point_M (double Dx, double Dy)
+// there is no server to absorb stray pixels, so this is safe too
+{
+  Safe_Point_M (Dx,Dy) ;
+  return 1 ;
+}
+
+
+
+static void Mm_Line (int x0, int r0, int x1, int r1)
+// Bresenham between two device pixels, both ends included
+// and both already inside the buffer.  The inner loops only
+// step a pointer and an integer error term ; a line that crosses
+// the edge of the clip rectangle also steps its coordinates, to
+// drop the pixels outside without moving the others.
+{
+  unsigned int *p = &MM_PIXEL(x0,r0) ;
+  unsigned int c = (unsigned int)Current_Color_Pixel ;
+  int dx = abs(x1 - x0) ;
+  int dr = abs(r1 - r0) ;
+  int sx = (x1 >= x0) ? 1 : -1 ;
+  int sr = (r1 >= r0) ? Xx_Pix_width : -Xx_Pix_width ;
+  int a = Current_Alpha_Weight ;
+  int e, n ;
+
+  if (dr == 0) {
+    if (x1 < x0) { n = x0 ; x0 = x1 ; x1 = n ; }
+    Mm_Span (x0, x1, r0) ;
+    return ;
+  }
+
+  if (Clip_On && ((x0 < Clip_c0) || (x0 > Clip_c1) || (x1 < Clip_c0) || (x1 > Clip_c1) ||
+                  (r0 < Clip_r0) || (r0 > Clip_r1) || (r1 < Clip_r0) || (r1 > Clip_r1))) {
+    int ir = (r1 >= r0) ? 1 : -1 ;
+#define MM_LINE_PUT(x,r) \
+    if (((x) >= Clip_c0) && ((x) <= Clip_c1) && ((r) >= Clip_r0) && ((r) <= Clip_r1)) \
+      Mm_Put (&MM_PIXEL(x,r), c, a) ;
+    if (dx >= dr) {
+      e = dx >> 1 ;
+      for (n = dx ; n >= 0 ; n--) {
+        MM_LINE_PUT (x0, r0) ;
+        x0 += sx ;
+        e -= dr ;
+        if (e < 0) { r0 += ir ; e += dx ; }
+      }
+    } else {
+      e = dr >> 1 ;
+      for (n = dr ; n >= 0 ; n--) {
+        MM_LINE_PUT (x0, r0) ;
+        r0 += ir ;
+        e -= dx ;
+        if (e < 0) { x0 += sx ; e += dr ; }
+      }
+    }
+#undef MM_LINE_PUT
+    return ;
+  }
+
+  if (dx >= dr) {
+    // x major : one pixel per column
+    e = dx >> 1 ;
+    for (n = dx ; n >= 0 ; n--) {
+      Mm_Put (p, c, a) ;
+      p += sx ;
+      e -= dr ;
+      if (e < 0) { p += sr ; e += dx ; }
+    }
+  } else {
+    // row major : one pixel per row
+    e = dr >> 1 ;
+    for (n = dr ; n >= 0 ; n--) {
+      Mm_Put (p, c, a) ;
+      p += sr ;
+      e -= dx ;
+      if (e < 0) { p += sx ; e += dr ; }
+    }
+  }
+}
+
+
+
+int Safe_Line_M (double Dxs, double Dys, double Dxe, double Dye)
+// same clipping as Safe_Line_X, then Bresenham into the buffer
+{
+  int ixs = (int)Dxs ;
+  int iys = (int)Dys ;
+  int ixe = (int)Dxe ;
+  int iye = (int)Dye ;
+
+  double xs, ys, xe, ye ;
+
+  if (Current_Pen_Width > 1) {
+    double x[2], y[2] ;
+    x[0] = Dxs ; y[0] = Dys ; x[1] = Dxe ; y[1] = Dye ;
+    return Mm_Stroke (x, y, 2, 0) ;
+  }
+
+  if (Mm_Antialias) {
+    Mm_Wu_Line (Dxs, Xx_Pix_height-1-Dys, Dxe, Xx_Pix_height-1-Dye) ;
+    return 1 ;
+  }
+
+  if (Clip_Out ((ixs < ixe) ? ixs : ixe, Xx_Pix_height - 1 - ((iys > iye) ? iys : iye),
+                (ixs > ixe) ? ixs : ixe, Xx_Pix_height - 1 - ((iys < iye) ? iys : iye))) return 1 ;
+
+  if (  (ixs < 0 ) || (ixs >= Xx_Pix_width)  
+     || (ixe < 0 ) || (ixe >= Xx_Pix_width)  
+     || (iys < 0 ) || (iys >= Xx_Pix_height)  
+     || (iye < 0 ) || (iye >= Xx_Pix_height)  ) {
+
+    xs = ixs ; ys = iys ; xe = ixe ; ye = iye ;
+    if (!Clip_Line_Liang_Barsky (&xs,&ys, &xe,&ye,
+                                 0, 0, Xx_Pix_width - 1, Xx_Pix_height - 1)) {
+      return 1 ;
+    }
+
+    // the clipped ends are on the box up to rounding ... 
+    // truncation and the guards keep them there
+    ixs = (int)xs ; iys = (int)ys ; ixe = (int)xe ; iye = (int)ye ;
+    if (ixs < 0) ixs = 0 ; else if (ixs >= Xx_Pix_width) ixs = Xx_Pix_width - 1 ;
+    if (ixe < 0) ixe = 0 ; else if (ixe >= Xx_Pix_width) ixe = Xx_Pix_width - 1 ;
+    if (iys < 0) iys = 0 ; else if (iys >= Xx_Pix_height) iys = Xx_Pix_height - 1 ;
+    if (iye < 0) iye = 0 ; else if (iye >= Xx_Pix_height) iye = Xx_Pix_height - 1 ;
+  }
+
+  Mm_Line (ixs, Xx_Pix_height-1-iys, ixe, Xx_Pix_height-1-iye) ;
+
+  return 1 ;
+}
+
+
+
+int Line_M (double Dxs, double Dys, double Dxe, double Dye)
+// the buffer has no slack around it, so always clip
+{
+  return Safe_Line_M (Dxs,Dys, Dxe,Dye) ;
+}
+
+
+
+int Horizontal_Single_Pixel_Line_M (double Dx0, double Dx1, double Dy)
+// same protection as Horizontal_Single_Pixel_Line_X
+{
+   int x0 = (int)Dx0 ;
+   int x1 = (int)Dx1 ;
+   int y = (int)Dy ;
+   int t ;
+
+   if (y < 0) return 0 ;
+   if (y >= Xx_Pix_height) return 0 ;
+
+   if (x0 > x1) { t = x1 ; x1 = x0 ; x0 = t ; }
+
+   if (x1 < 0) return 0 ;
+   if (x0 >= Xx_Pix_width) return 0 ;
+
+   if (x0 < 0) x0 = 0 ;
+   if (x1 >= Xx_Pix_width) x1 = Xx_Pix_width - 1 ;
+
+   Mm_Span (x0, x1, Xx_Pix_height - 1 - y) ;
+   
+   return 1 ;
+} 
+
+
+
+int Rectangle_M (double Dxlow, double Dylow, double Dwidth, double Dheight) 
+// the same pixels as XDrawRectangle : (width+1) x (height+1)
+{
+  int xlow = (int)Dxlow ;
+  int ylow = (int)Dylow ;
+  int width = (int)Dwidth ;
+  int height = (int)Dheight ; 
+
+  if (Current_Pen_Width > 1) {
+    double x[4], y[4] ;
+    x[0] = xlow ;         y[0] = ylow ;
+    x[1] = xlow + width ; y[1] = ylow ;
+    x[2] = x[1] ;         y[2] = ylow + height ;
+    x[3] = xlow ;         y[3] = y[2] ;
+    return Mm_Stroke (x, y, 4, 1) ;
+  }
+
+  Safe_Line_M (xlow, ylow, xlow + width, ylow) ;
+  Safe_Line_M (xlow + width, ylow, xlow + width, ylow + height) ;
+  Safe_Line_M (xlow + width, ylow + height, xlow, ylow + height) ;
+  Safe_Line_M (xlow, ylow + height, xlow, ylow) ;
+
+  return 1 ;  
+}
+
+
+
+int Fill_Rectangle_M (double Dxlow, double Dylow, double Dwidth, double Dheight) 
+// the same pixels as XFillRectangle : width x height
+{
+  int x0 = (int)Dxlow ;
+  int y0 = (int)Dylow ;
+  int x1 = x0 + (int)Dwidth - 1 ;
+  int y1 = y0 + (int)Dheight - 1 ; 
+  int y ;
+
+  if (Mm_Antialias) {
+    // the same place as the aliased one : pixel y spans [y,y+1)
+    double x[4], row[4] ;
+    x[0] = Dxlow ;          row[0] = Xx_Pix_height - Dylow ;
+    x[1] = Dxlow + Dwidth ; row[1] = row[0] ;
+    x[2] = x[1] ;           row[2] = Xx_Pix_height - Dylow - Dheight ;
+    x[3] = x[0] ;           row[3] = row[2] ;
+    return Mm_Cover_Polygon (x, row, 4) ;
+  }
+
+  if (x0 < Clip_c0) x0 = Clip_c0 ;
+  if (y0 < Xx_Pix_height - 1 - Clip_r1) y0 = Xx_Pix_height - 1 - Clip_r1 ;
+  if (x1 > Clip_c1) x1 = Clip_c1 ;
+  if (y1 > Xx_Pix_height - 1 - Clip_r0) y1 = Xx_Pix_height - 1 - Clip_r0 ;
+  if ((x0 > x1) || (y0 > y1)) return 1 ;
+
+  for (y = y0 ; y <= y1 ; y++) {
+    Mm_Span (x0, x1, Xx_Pix_height - 1 - y) ;
+  }
+
+  return 1 ;  
+}
+
+
+
+int Triangle_M (double Dx1, double Dy1, 
+                double Dx2, double Dy2,
+                double Dx3, double Dy3)
+{
+  if (Current_Pen_Width > 1) {
+    double x[3], y[3] ;
+    x[0] = Dx1 ; y[0] = Dy1 ; x[1] = Dx2 ; y[1] = Dy2 ; x[2] = Dx3 ; y[2] = Dy3 ;
+    return Mm_Stroke (x, y, 3, 1) ;
+  }
+
+  Safe_Line_M (Dx1,Dy1, Dx2,Dy2) ;
+  Safe_Line_M (Dx2,Dy2, Dx3,Dy3) ;
+  Safe_Line_M (Dx3,Dy3, Dx1,Dy1) ;
+
+  return 1 ;  
+}
+
+
+
+int Polygon_XPoints_M (XPoint *xpoint, int npts)
+// xpoint[] is already in device coordinates (y flipped)
+{
+   int k, s ;
+
+   if (npts <= 0) return 0 ;
+
+   if (Current_Pen_Width > 1) {
+     double *x, *y ;
+     x = (double *) malloc(2 * npts * sizeof(double)) ;
+     if (x == NULL) return 0 ;
+     y = x + npts ;
+     for (k = 0 ; k < npts ; k++) {
+       x[k] = xpoint[k].x ;
+       y[k] = Xx_Pix_height - 1 - xpoint[k].y ;
+     }
+     s = Mm_Stroke (x, y, npts, 1) ;
+     free(x) ;
+     return s ;
+   }
+
+   for (k = 0 ; k < npts ; k++) {
+     int j = (k + 1 < npts) ? k + 1 : 0 ;
+     Safe_Line_M (xpoint[k].x, Xx_Pix_height - 1 - xpoint[k].y,
+                  xpoint[j].x, Xx_Pix_height - 1 - xpoint[j].y) ;
+   }
+
+   return 1 ;
+}
+
+
+
+int Polygon_M (int *x, int *y, int npts)
+{
+   int k, s ;
+
+   if (npts <= 0) return 0 ;
+
+   if (Current_Pen_Width > 1) {
+     double *dx, *dy ;
+     dx = (double *) malloc(2 * npts * sizeof(double)) ;
+     if (dx == NULL) return 0 ;
+     dy = dx + npts ;
+     for (k = 0 ; k < npts ; k++) { dx[k] = x[k] ; dy[k] = y[k] ; }
+     s = Mm_Stroke (dx, dy, npts, 1) ;
+     free(dx) ;
+     return s ;
+   }
+
+   for (k = 0 ; k < npts ; k++) {
+     int j = (k + 1 < npts) ? k + 1 : 0 ;
+     Safe_Line_M (x[k],y[k], x[j],y[j]) ;
+   }
+
+   return 1 ;
+}
+
+
+
+int Polygon_DM (double *x, double *y, double Dnpts)
+{
+  int npts = (int)Dnpts ;
+   int k ;
+
+   if (npts <= 0) return 0 ;
+
+   if (Current_Pen_Width > 1) return Mm_Stroke (x, y, npts, 1) ;
+
+   for (k = 0 ; k < npts ; k++) {
+     int j = (k + 1 < npts) ? k + 1 : 0 ;
+     Safe_Line_M (x[k],y[k], x[j],y[j]) ;
+   }
+
+   return 1 ;
+}
+
+
+
+int Polyline_DM (double *x, double *y, double Dnpts)
+// an open path, with joins at the inner points only
+{
+  int npts = (int)Dnpts ;
+   int k ;
+
+   if (npts <= 0) return 0 ;
+
+   if (Current_Pen_Width > 1) return Mm_Stroke (x, y, npts, 0) ;
+
+   for (k = 0 ; k + 1 < npts ; k++) {
+     Safe_Line_M (x[k],y[k], x[k+1],y[k+1]) ;
+   }
+
+   return 1 ;
+}
+
+
+
+typedef struct {
+  int row0, row1 ; // first and last device rows whose pixel centers it spans
+  double x, dx ;   // crossing at the center of row0, change per row
+  int dir ;        // +1 going down the rows, -1 going up (Mm_Fill_Segs only)
+  int den ;        // Scan_Device_Polygon keeps x and dx exact, as integers over den
+} Mm_Edge ;
+
+
+
+static int Scan_Device_Polygon (int *x, int *row, int npts, int clip,
+                                void (*span) (int x0, int x1, int row))
+// Even-odd scanline fill in device coordinates (the XFillPolygon rule) :
+// a pixel is set when its center is inside.  Edges are bucketed by their
+// first row and kept in an active list, so each row only touches the
+// edges that cross it.  The crossings are exact integer fractions, so
+// moving the polygon by whole pixels moves its pixels the same.  The runs
+// of pixels go to span, row by row and left to right, cut to the clip
+// rectangle if clip is set.
+// return 0 if the work arrays could not be allocated, else 1
+{
+  Mm_Edge *edge ;
+  int *order, *active ;
+  double *xs ;
+  int nedges, nactive, next, r, rlo, rhi, k, j, i, t ;
+  int x0, x1, y0, y1 ;
+  long long n, q ;
+  double tx ;
+
+  if (npts < 3) return 1 ;
+
+  edge = (Mm_Edge *) malloc(npts * sizeof(Mm_Edge)) ;
+  order = (int *) malloc(3 * npts * sizeof(int)) ;
+  xs = (double *) malloc(npts * sizeof(double)) ;
+  if ((edge == NULL) || (order == NULL) || (xs == NULL)) {
+    free(edge) ; free(order) ; free(xs) ;
+    return 0 ;
+  }
+  active = order + npts ;
+
+  // build the edge table, dropping horizontal edges
+  nedges = 0 ;
+  rlo = INT_MAX ; rhi = INT_MIN ;
+  for (k = 0 ; k < npts ; k++) {
+    j = (k + 1 < npts) ? k + 1 : 0 ;
+    if (row[k] == row[j]) continue ;
+    if (row[k] < row[j]) { x0 = x[k] ; y0 = row[k] ; x1 = x[j] ; y1 = row[j] ; }
+    else                 { x0 = x[j] ; y0 = row[j] ; x1 = x[k] ; y1 = row[k] ; }
+    // rows r with y0 <= r + 0.5 < y1, i.e. y0 <= r < y1 for integer ends
+    edge[nedges].row0 = (clip && (y0 < Clip_r0)) ? Clip_r0 : y0 ;
+    edge[nedges].row1 = (clip && (y1 > Clip_r1 + 1)) ? Clip_r1 : y1 - 1 ;
+    if (edge[nedges].row0 > edge[nedges].row1) continue ;
+    // crossing - 1/2 at the center of row0, times den = 2 (y1 - y0)
+    edge[nedges].den = 2 * (y1 - y0) ;
+    edge[nedges].dx = 2.0 * (x1 - x0) ;
+    edge[nedges].x = (double)edge[nedges].den * x0 - (y1 - y0)
+                     + (2.0 * (edge[nedges].row0 - y0) + 1) * (x1 - x0) ;
+    if (edge[nedges].row0 < rlo) rlo = edge[nedges].row0 ;
+    if (edge[nedges].row1 > rhi) rhi = edge[nedges].row1 ;
+    order[nedges] = nedges ;
+    nedges++ ;
+  }
+
+  // sort the edges by first row (insertion sort, polygons are small
+  // and usually close to sorted already)
+  for (k = 1 ; k < nedges ; k++) {
+    t = order[k] ;
+    for (j = k - 1 ; (j >= 0) && (edge[order[j]].row0 > edge[t].row0) ; j--) {
+      order[j+1] = order[j] ;
+    }
+    order[j+1] = t ;
+  }
+
+  nactive = 0 ;
+  next = 0 ;
+  for (r = rlo ; r <= rhi ; r++) {
+
+    // retire finished edges, admit the ones that start here
+    for (k = 0, j = 0 ; k < nactive ; k++) {
+      if (edge[active[k]].row1 >= r) active[j++] = active[k] ;
+    }
+    nactive = j ;
+    while ((next < nedges) && (edge[order[next]].row0 == r)) {
+      active[nactive++] = order[next++] ;
+    }
+
+    // first pixel centers right of the crossings, in increasing x
+    for (k = 0 ; k < nactive ; k++) {
+      n = (long long)edge[active[k]].x ;
+      q = n / edge[active[k]].den ;
+      if (q * edge[active[k]].den < n) q++ ;
+      tx = (double)q ;
+      for (i = k - 1 ; (i >= 0) && (xs[i] > tx) ; i--) xs[i+1] = xs[i] ;
+      xs[i+1] = tx ;
+      edge[active[k]].x += edge[active[k]].dx ;
+    }
+
+    // pixel centers c + 0.5 between crossings k and k+1
+    for (k = 0 ; k + 1 < nactive ; k += 2) {
+      x0 = (int)xs[k] ;
+      x1 = (int)xs[k+1] - 1 ;
+      if (clip) {
+        if (x0 < Clip_c0) x0 = Clip_c0 ;
+        if (x1 > Clip_c1) x1 = Clip_c1 ;
+      }
+      if (x0 <= x1) span (x0, x1, r) ;
+    }
+  }
+
+  free(edge) ;
+  free(order) ;
+  free(xs) ;
+  return 1 ;
+}
+
+
+
+static int Mm_Fill_Device_Polygon (int *x, int *row, int npts)
+{
+  return Scan_Device_Polygon (x, row, npts, 1, Mm_Span) ;
+}
+
+
+
+int Fill_Polygon_XPoints_M (XPoint *xpoint, int npts)
+// xpoint[] is already in device coordinates (y flipped)
+{
+   int *x, *row ;
+   int k, s ;
+
+   if (npts <= 0) return 0 ;
+
+   if (Mm_Antialias) {
+     double *dx, *drow ;
+     dx = (double *) malloc(2 * npts * sizeof(double)) ;
+     if (dx == NULL) return 0 ;
+     drow = dx + npts ;
+     for (k = 0 ; k < npts ; k++) {
+       dx[k] = xpoint[k].x ;
+       drow[k] = xpoint[k].y ;
+     }
+     s = Mm_Cover_Polygon (dx, drow, npts) ;
+     free(dx) ;
+     return s ;
+   }
+
+   x = (int *) malloc(2 * npts * sizeof(int)) ;
+   if (x == NULL) return 0 ;
+   row = x + npts ;
+   for (k = 0 ; k < npts ; k++) {
+     x[k] = xpoint[k].x ;
+     row[k] = xpoint[k].y ;
+   }
+   s = Mm_Fill_Device_Polygon (x, row, npts) ;
+   free(x) ;
+
+   return s ;
+}
+
+
+
+int Fill_Polygon_M (int *x, int *y, int npts)
+{
+   int xx[1000], row[1000] ;
+   int k ;
+
+   if (npts <= 0) return 0 ;
+
+   if (npts > 1000) {
+      printf("\nFill_Polygon_M has been asked to deal with %d points.\n",
+             npts) ;
+      printf("Points past first 1000 ignored.\n") ;
+      npts = 1000 ;
+   }
+
+   if (Mm_Antialias) {
+     double dx[1000], drow[1000] ;
+     for (k = 0 ; k < npts ; k++) {
+       dx[k] = x[k] ;
+       drow[k] = Xx_Pix_height - 1 - y[k] ;
+     }
+     return Mm_Cover_Polygon (dx, drow, npts) ;
+   }
+
+   for (k = 0 ; k < npts ; k++) {
+        xx[k] = x[k] ; 
+        row[k] = Xx_Pix_height -1 - y[k] ;
+   }
+
+   return Mm_Fill_Device_Polygon (xx, row, npts) ;
+}
+
+
+
+int Fill_Polygon_DM (double *x, double *y, double Dnpts)
+{
+  int npts = (int)Dnpts ;
+   int xx[1000], row[1000] ;
+   int k ;
+
+   if (npts <= 0) return 0 ;
+
+   if (npts > 1000) {
+      printf("\nFill_Polygon_M has been asked to deal with %d points.\n",
+             npts) ;
+      printf("Points past first 1000 ignored.\n") ;
+      npts = 1000 ;
+   }
+
+   if (Mm_Antialias) {
+     // no truncation, the edges keep their exact positions
+     double drow[1000] ;
+     for (k = 0 ; k < npts ; k++) drow[k] = Xx_Pix_height - 1 - y[k] ;
+     return Mm_Cover_Polygon (x, drow, npts) ;
+   }
+
+   for (k = 0 ; k < npts ; k++) {
+        xx[k] = (int)x[k] ; 
+        row[k] = (int)(Xx_Pix_height -1 - y[k]) ;
+   }
+
+   return Mm_Fill_Device_Polygon (xx, row, npts) ;
+}
+
+
+
+int Fill_Prepared_Polygon_M (G_Prepared_Polygon *p, double Ddx, double Ddy)
+// the rectangles as spans ; antialiased, the polygon is covered
+// again from its vertices, at the exact offset
+{
+  int dx, dy, k, x0, x1, r0, r1 ;
+  int *q ;
+
+  if (p == NULL) return 0 ;
+
+  if (Mm_Antialias) {
+    double *x, *row ;
+    int s ;
+    x = (double *) malloc(2 * p->n * sizeof(double)) ;
+    if (x == NULL) return 0 ;
+    row = x + p->n ;
+    for (k = 0 ; k < p->n ; k++) {
+      x[k] = p->x[k] + Ddx ;
+      row[k] = Xx_Pix_height - 1 - (p->y[k] + Ddy) ;
+    }
+    s = Mm_Cover_Polygon (x, row, p->n) ;
+    free(x) ;
+    return s ;
+  }
+
+  dx = (int)floor(Ddx + 0.5) ;
+  dy = Xx_Pix_height - 1 - (int)floor(Ddy + 0.5) ;
+
+  if (Clip_Out (p->x0 + dx, p->top0 + dy, p->x1 + dx, p->top1 + dy)) return 1 ;
+
+  for (k = 0, q = p->rect ; k < p->nrect ; k++, q += 4) {
+    x0 = q[0] + dx ; x1 = x0 + q[2] - 1 ;
+    r0 = q[1] + dy ; r1 = r0 + q[3] - 1 ;
+    if (x0 < Clip_c0) x0 = Clip_c0 ;
+    if (x1 > Clip_c1) x1 = Clip_c1 ;
+    if (r0 < Clip_r0) r0 = Clip_r0 ;
+    if (r1 > Clip_r1) r1 = Clip_r1 ;
+    if (x0 > x1) continue ;
+    for ( ; r0 <= r1 ; r0++) Mm_Span (x0, x1, r0) ;
+  }
+
+  return 1 ;
+}
+
+
+
+static int Mm_Fill_Segs ()
+// Nonzero winding scanline fill of the edges in Mm_Segs, sampled at
+// pixel centers like Mm_Fill_Device_Polygon.  Where pieces of a shape
+// overlap, the winding only grows, so each pixel is still set once.
+// Strokes have many short edges that start in no particular order,
+// so instead of sorting the crossings of a row, each one adds its
+// direction to the cell of the first pixel it starts or ends, and a
+// running sum along the row gives the winding of every pixel, as
+// Mm_Cover_Segs does with areas.
+// return 0 if the work arrays could not be allocated, else 1
+{
+  Mm_Edge *edge, *a ;
+  Mm_Seg *e ;
+  int *order, *active, *count, *cell ;
+  int nedges, nactive, next, r, rlo, rhi, k, j, w, c, clo, chi, start ;
+  double xa, ra, xb, rb, tx ;
+  int n = Mm_Nsegs ;
+
+  if (n == 0) return 1 ;
+
+  edge = (Mm_Edge *) malloc(n * sizeof(Mm_Edge)) ;
+  order = (int *) malloc((2 * n + Xx_Pix_height + Xx_Pix_width + 2) * sizeof(int)) ;
+  if ((edge == NULL) || (order == NULL)) {
+    free(edge) ; free(order) ;
+    return 0 ;
+  }
+  active = order + n ;
+  count = active + n ;
+  cell = count + Xx_Pix_height + 1 ;
+  memset(cell, 0, (Xx_Pix_width + 1) * sizeof(int)) ;
+
+  nedges = 0 ;
+  rlo = Xx_Pix_height ; rhi = -1 ;
+  for (k = 0 ; k < n ; k++) {
+    e = &Mm_Segs[k] ;
+    a = &edge[nedges] ;
+    if (e->r0 < e->r1) { xa = e->x0 ; ra = e->r0 ; xb = e->x1 ; rb = e->r1 ; a->dir = 1 ; }
+    else               { xa = e->x1 ; ra = e->r1 ; xb = e->x0 ; rb = e->r0 ; a->dir = -1 ; }
+    // rows r with ra <= r + 0.5 < rb
+    if ((rb <= 0) || (ra >= Xx_Pix_height)) continue ;
+    a->row0 = (ra < 0) ? 0 : (int)ceil(ra - 0.5) ;
+    a->row1 = (rb > Xx_Pix_height) ? Xx_Pix_height - 1 : (int)ceil(rb - 0.5) - 1 ;
+    if (a->row0 > a->row1) continue ;
+    a->dx = (xb - xa) / (rb - ra) ;
+    a->x = xa + (a->row0 + 0.5 - ra) * a->dx ;
+    if (a->row0 < rlo) rlo = a->row0 ;
+    if (a->row1 > rhi) rhi = a->row1 ;
+    nedges++ ;
+  }
+
+  // order the edges by first row ; strokes come in any order and
+  // have many edges, so this is a counting sort
+  memset(count, 0, (Xx_Pix_height + 1) * sizeof(int)) ;
+  for (k = 0 ; k < nedges ; k++) count[edge[k].row0 + 1]++ ;
+  for (r = 1 ; r <= Xx_Pix_height ; r++) count[r] += count[r-1] ;
+  for (k = 0 ; k < nedges ; k++) order[count[edge[k].row0]++] = k ;
+
+  nactive = 0 ;
+  next = 0 ;
+  for (r = rlo ; r <= rhi ; r++) {
+
+    for (k = 0, j = 0 ; k < nactive ; k++) {
+      if (edge[active[k]].row1 >= r) active[j++] = active[k] ;
+    }
+    nactive = j ;
+    while ((next < nedges) && (edge[order[next]].row0 == r)) {
+      active[nactive++] = order[next++] ;
+    }
+
+    // cell c gets the crossings with c - 0.5 < x <= c + 0.5 ; the
+    // crossings are kept near the buffer so that they convert to int
+    clo = Xx_Pix_width ; chi = 0 ;
+    for (k = 0 ; k < nactive ; k++) {
+      a = &edge[active[k]] ;
+      tx = a->x ;
+      if (tx < 0) tx = 0 ; else if (tx > Xx_Pix_width) tx = Xx_Pix_width ;
+      a->x += a->dx ;
+      c = (int)ceil(tx - 0.5) ;
+      cell[c] += a->dir ;
+      if (c < clo) clo = c ;
+      if (c > chi) chi = c ;
+    }
+
+    // spans run from where the winding leaves 0 to where it returns
+    w = 0 ;
+    start = 0 ;
+    for (c = clo ; c <= chi ; c++) {
+      if (cell[c] == 0) continue ;
+      if (w == 0) start = c ;
+      w += cell[c] ;
+      cell[c] = 0 ;
+      if (w == 0) Mm_Span (start, c - 1, r) ;
+    }
+  }
+
+  free(edge) ;
+  free(order) ;
+  return 1 ;
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+// Wide pens for the memory backend.  A stroke becomes one set of
+// edges in Mm_Segs : a rectangle along each segment and a wedge
+// at each join (mitered, round or beveled), all wound the same
+// way.  A single nonzero fill of the whole set then paints each
+// pixel once, whatever the overlaps, so a wide path costs about
+// one polygon fill and a translucent one does not darken at its
+// corners.  The pen is centered on the pixels of the thin line
+// and its ends are cut square, like X's CapButt.
+/////////////////////////////////////////////////////////////////
+
+#define MM_MITER_LIMIT 10.0 // longest miter in half widths ; beyond it, a bevel
+#define MM_ARC_STEPS 128    // most sides of a round join
+
+
+
+static void Mm_Add_Piece (double *x, double *r, int n)
+// the convex polygon x[],r[] as edges wound counterclockwise (in x,row)
+{
+  double a = 0 ;
+  int k, j ;
+
+  for (k = 0 ; k < n ; k++) {
+    j = (k + 1 < n) ? k + 1 : 0 ;
+    a += x[k]*r[j] - x[j]*r[k] ;
+  }
+  if (a == 0) return ;
+
+  for (k = 0 ; k < n ; k++) {
+    j = (k + 1 < n) ? k + 1 : 0 ;
+    if (a > 0) Mm_Add_Seg (x[k], r[k], x[j], r[j]) ;
+    else       Mm_Add_Seg (x[j], r[j], x[k], r[k]) ;
+  }
+}
+
+
+
+static void Mm_Add_Join (double px, double pr,
+                         double ux0, double ur0, double ux1, double ur1, double hw)
+// The wedge at (px,pr) where a segment in the unit direction (ux0,ur0)
+// turns into one in (ux1,ur1).  It fills the gap between their two
+// rectangles on the outside of the turn ; hw is half the pen width.
+{
+  double x[MM_ARC_STEPS + 3], r[MM_ARC_STEPS + 3] ;
+  double cross = ux0*ur1 - ur0*ux1 ;
+  double dot = ux0*ux1 + ur0*ur1 ;
+  double s, nx0, nr0, nx1, nr1, sweep, step, a0, a ;
+  int n, m, k ;
+
+  if ((cross == 0) && (dot > 0)) return ; // straight on
+
+  // offsets of the two outer corners from the join
+  s = (cross > 0) ? -hw : hw ;
+  nx0 = -ur0 * s ; nr0 = ux0 * s ;
+  nx1 = -ur1 * s ; nr1 = ux1 * s ;
+
+  // the apex is a hair inside the turn : the join point lies on the
+  // cut ends of both rectangles, and this puts it inside a piece
+  x[0] = px + 1e-3 * (ux1 - ux0) ; r[0] = pr + 1e-3 * (ur1 - ur0) ;
+  x[1] = px + nx0 ; r[1] = pr + nr0 ;
+  n = 2 ;
+
+  if (Current_Pen_Join == G_JOIN_ROUND) {
+    // around the outside, in steps that stay within 1/4 pixel of the circle
+    sweep = acos((dot < -1) ? -1 : (dot > 1) ? 1 : dot) ;
+    step = (hw > 0.25) ? 2 * acos(1 - 0.25 / hw) : sweep ;
+    m = (int)ceil(sweep / step) ;
+    if (m > MM_ARC_STEPS) m = MM_ARC_STEPS ;
+    if (cross <= 0) sweep = -sweep ;
+    a0 = atan2(nr0, nx0) ;
+    for (k = 1 ; k < m ; k++) {
+      a = a0 + sweep * k / m ;
+      x[n] = px + hw * cos(a) ;
+      r[n] = pr + hw * sin(a) ;
+      n++ ;
+    }
+  } else if ((Current_Pen_Join == G_JOIN_MITER) &&
+             ((1 + dot) * MM_MITER_LIMIT * MM_MITER_LIMIT > 2)) {
+    // where the outer sides meet, sqrt(2/(1+dot)) half widths out
+    x[n] = px + (nx0 + nx1) / (1 + dot) ;
+    r[n] = pr + (nr0 + nr1) / (1 + dot) ;
+    n++ ;
+  }
+
+  x[n] = px + nx1 ; r[n] = pr + nr1 ;
+  n++ ;
+  Mm_Add_Piece (x, r, n) ;
+}
+
+
+
+static int Mm_Stroke (double *x, double *y, int npts, int closed)
+// Draw the path x[],y[] (window coordinates) with the current pen ;
+// closed also joins the last point back to the first.  Aliased,
+// the points are truncated to integers first, as the thin lines do.
+// return 0 if the edges or the work arrays could not be allocated
+{
+  double hw = 0.5 * Current_Pen_Width ;
+  double qx[4], qr[4] ;
+  double px, pr, nx, nr, dx, dr, len, ux, ur, pux = 0, pur = 0, fux = 0, fur = 0 ;
+  double xlo, xhi, ylo, yhi ;
+  int k, j, nseg, m ;
+
+  if (npts <= 0) return 1 ;
+
+  // skip a path that cannot reach the clip rectangle
+  xlo = xhi = x[0] ; ylo = yhi = y[0] ;
+  for (k = 1 ; k < npts ; k++) {
+    if (x[k] < xlo) xlo = x[k] ; else if (x[k] > xhi) xhi = x[k] ;
+    if (y[k] < ylo) ylo = y[k] ; else if (y[k] > yhi) yhi = y[k] ;
+  }
+  m = Clip_Pen_Margin () + 1 ;
+  if (Clip_Out ((int)floor(xlo) - m, (int)floor(Xx_Pix_height - 1 - yhi) - m,
+                (int)ceil(xhi) + m, (int)ceil(Xx_Pix_height - 1 - ylo) + m)) return 1 ;
+
+  Mm_Nsegs = 0 ;
+  Mm_Segs_failed = 0 ;
+
+  // pixel centers are at +0.5 in the continuous coordinates of the fills
+  #define MM_STROKE_X(k) ((Mm_Antialias ? x[k] : (int)x[k]) + 0.5)
+  #define MM_STROKE_R(k) (Xx_Pix_height - 0.5 - (Mm_Antialias ? y[k] : (int)y[k]))
+
+  px = MM_STROKE_X(0) ; pr = MM_STROKE_R(0) ;
+  nseg = 0 ;
+  for (k = 1 ; k < (closed ? npts + 1 : npts) ; k++) {
+    j = (k < npts) ? k : 0 ;
+    dx = MM_STROKE_X(j) - px ;
+    dr = MM_STROKE_R(j) - pr ;
+    len = sqrt(dx*dx + dr*dr) ;
+    if (len == 0) continue ; // repeated points make no corner
+    ux = dx / len ; ur = dr / len ;
+    nx = -ur * hw ; nr = ux * hw ;
+
+    qx[0] = px + nx ;      qr[0] = pr + nr ;
+    qx[1] = px + dx + nx ; qr[1] = pr + dr + nr ;
+    qx[2] = px + dx - nx ; qr[2] = pr + dr - nr ;
+    qx[3] = px - nx ;      qr[3] = pr - nr ;
+    Mm_Add_Piece (qx, qr, 4) ;
+
+    if (nseg == 0) { fux = ux ; fur = ur ; }
+    else Mm_Add_Join (px, pr, pux, pur, ux, ur, hw) ;
+    pux = ux ; pur = ur ;
+    nseg++ ;
+    px += dx ; pr += dr ;
+  }
+  if (closed && (nseg > 1)) Mm_Add_Join (px, pr, pux, pur, fux, fur, hw) ;
+
+  #undef MM_STROKE_X
+  #undef MM_STROKE_R
+
+  if (Mm_Segs_failed) return 0 ;
+  return Mm_Antialias ? Mm_Cover_Segs (1) : Mm_Fill_Segs () ;
+}
+
+
+
+static int Mm_Ring (double cx, double cr, double ri, double ro)
+// A circle drawn with a wide pen : the pixels whose centers are from
+// ri to ro away from (cx,cr), in the pixel center coordinates of the
+// thin circles.  Antialiased, the rims are blended by distance.  Each
+// row is at most two runs, one on each side of the hole.
+// return 0 if the work area could not be allocated, else 1
+{
+  double e = Mm_Antialias ? 0.5 : 0 ;
+  double dy, wo, wi, d, f, g ;
+  int r, rlo, rhi, c, c0, c1, last, k ;
+  float *cov ;
+
+  if (ri < 0) ri = 0 ;
+  if (ro <= ri) return 1 ;
+  if (Clip_c0 > Clip_c1) return 1 ;
+  if ((cx + ro + e < Clip_c0) || (cx - ro - e > Clip_c1)) return 1 ;
+  if ((cr + ro + e < Clip_r0) || (cr - ro - e > Clip_r1)) return 1 ;
+
+  cov = Mm_Work (Xx_Pix_width) ;
+  if (cov == NULL) return 0 ;
+
+  rlo = (cr - ro - e < Clip_r0) ? Clip_r0 : (int)ceil(cr - ro - e) ;
+  rhi = (cr + ro + e > Clip_r1) ? Clip_r1 : (int)floor(cr + ro + e) ;
+
+  for (r = rlo ; r <= rhi ; r++) {
+    dy = r - cr ;
+    wo = (ro + e)*(ro + e) - dy*dy ;
+    if (wo < 0) continue ;
+    wo = sqrt(wo) ;
+    // half width of the part of the hole that is clear of the pen
+    wi = (ri - e)*(ri - e) - dy*dy ;
+    wi = ((ri > e) && (wi > 0)) ? sqrt(wi) : -1 ;
+
+    last = -1 ;
+    for (k = 0 ; k < 2 ; k++) {
+      if (wi < 0) {
+        if (k == 1) break ;
+        c0 = (int)ceil(cx - wo) ; c1 = (int)floor(cx + wo) ;
+      } else if (k == 0) {
+        c0 = (int)ceil(cx - wo) ; c1 = (int)floor(cx - wi) ;
+      } else {
+        c0 = (int)ceil(cx + wi) ; c1 = (int)floor(cx + wo) ;
+      }
+      if (c0 <= last) c0 = last + 1 ;
+      if (c0 < Clip_c0) c0 = Clip_c0 ;
+      if (c1 > Clip_c1) c1 = Clip_c1 ;
+      if (c0 > c1) continue ;
+      last = c1 ;
+
+      for (c = c0 ; c <= c1 ; c++) {
+        d = sqrt((c - cx)*(c - cx) + dy*dy) ;
+        if (Mm_Antialias) {
+          f = ro + 0.5 - d ;
+          g = d - ri + 0.5 ;
+          if (g < f) f = g ;
+          if (f < 0) f = 0 ; else if (f > 1) f = 1 ;
+        } else {
+          f = ((d >= ri) && (d <= ro)) ? 1 : 0 ;
+        }
+        cov[c - c0] = (float)f ;
+      }
+      Mm_Blend_Coverage (&MM_PIXEL(c0, r), cov, c1 - c0 + 1) ;
+    }
+  }
+
+  return 1 ;
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+// Triangle rasterizer for the memory backend :
+// half-space (edge function) tests in fixed point with
+// MM_SUBPIXEL_BITS bits of sub-pixel precision and the top-left
+// fill rule, so triangles that share an edge never share or
+// miss a pixel.  With SSE2 the bounding box is walked in 4x4
+// blocks : blocks outside an edge are skipped whole, blocks
+// inside all three are filled without any per-pixel test, and
+// the rest test 4 pixels per instruction.  Colors given at the
+// vertices are interpolated across the triangle (Gouraud).
+/////////////////////////////////////////////////////////////////
+
+#define MM_SUBPIXEL_BITS 4
+#define MM_SUBPIXEL (1 << MM_SUBPIXEL_BITS)
+#define MM_COORD_GUARD 1048576.0
+// vertices are clamped to +- this many pixels, which keeps
+// every edge function value well inside 64 bits
+
+#define MM_SIMD_SPAN (1 << 14)
+// when the triangle spans less than this many fixed point units
+// in x and y, every edge function value fits in 32 bits
+
+
+typedef struct {
+  long long A[3], B[3], C[3] ; // E_i(px,py) = A*px + B*py + C in fixed point
+  int bias[3] ;                // 0 on top-left edges, -1 on the others
+  int xmin, xmax, rmin, rmax ; // pixel bounding box, clipped to the buffer
+  int small ;                  // 1 if the 32 bit path may be used
+  int shaded ;                 // 1 to interpolate the colors below
+  float c0[3], cdx[3], cdy[3] ;// r,g,b at the center of (xmin,rmin), and per pixel steps
+  unsigned int flat ;          // the pixel value when not shaded
+  int depth ;                  // 1 to depth test with the plane below
+  double z0, zdx, zdy ;        // depth at the center of (xmin,rmin), and per pixel steps
+  double zlo ;                 // the nearest vertex depth
+  Xx_Batch *runs ;             // if not NULL, the depth test sends the pixels
+                               // that pass here as X runs instead of drawing them
+} Mm_Triangle ;
+
+
+
+static void Mm_Plane (const Mm_Triangle *t, double area, const double w[3], double p[3])
+// the plane taking the value w[i] at the vertex opposite edge i,
+// as sum_i E_i w[i] / area : p[0] is its value at the center of
+// pixel (xmin,rmin), p[1] and p[2] its steps per pixel in x and row
+{
+  long long pcx = (long long)t->xmin * MM_SUBPIXEL + MM_SUBPIXEL/2 ;
+  long long pcy = (long long)t->rmin * MM_SUBPIXEL + MM_SUBPIXEL/2 ;
+  double c = 0, dx = 0, dy = 0 ;
+  int i ;
+
+  for (i = 0 ; i < 3 ; i++) {
+    c  += (double)(t->A[i] * pcx + t->B[i] * pcy + t->C[i]) * w[i] ;
+    dx += (double)t->A[i] * w[i] ;
+    dy += (double)t->B[i] * w[i] ;
+  }
+  p[0] = c / area ;
+  p[1] = dx * MM_SUBPIXEL / area ;
+  p[2] = dy * MM_SUBPIXEL / area ;
+}
+
+
+
+static int Mm_Setup_Triangle (Mm_Triangle *t, double x[3], double row[3],
+                              double rgb[3][3], double z[3])
+// x[], row[] are continuous device coordinates : pixel (c,r) is the
+// unit square [c,c+1) x [r,r+1) and is covered when its center is.
+// rgb[] (0..255 per channel) may be NULL for a flat fill, and
+// z[] may be NULL for no depth test.
+// return 0 if no pixel can be covered, else 1
+{
+  long long X[3], Y[3] ;
+  double area, sx, sy, w[3], p[3] ;
+  int i, j, k, v[3] ;
+  long long xlo, xhi, ylo, yhi ;
+
+  for (i = 0 ; i < 3 ; i++) {
+    sx = x[i] ; sy = row[i] ;
+    if (sx < -MM_COORD_GUARD) sx = -MM_COORD_GUARD ; else if (sx > MM_COORD_GUARD) sx = MM_COORD_GUARD ;
+    if (sy < -MM_COORD_GUARD) sy = -MM_COORD_GUARD ; else if (sy > MM_COORD_GUARD) sy = MM_COORD_GUARD ;
+    X[i] = (long long)floor(sx * MM_SUBPIXEL + 0.5) ;
+    Y[i] = (long long)floor(sy * MM_SUBPIXEL + 0.5) ;
+  }
+
+  // orient the vertices so that the inside is where all E_i > 0
+  v[0] = 0 ; v[1] = 1 ; v[2] = 2 ;
+  area = (double)(X[1] - X[0]) * (Y[2] - Y[0]) - (double)(Y[1] - Y[0]) * (X[2] - X[0]) ;
+  if (area == 0) return 0 ;
+  if (area < 0) { v[1] = 2 ; v[2] = 1 ; area = -area ; }
+
+  // edge i joins the two vertices other than v[i]
+  for (i = 0 ; i < 3 ; i++) {
+    j = v[(i + 1) % 3] ;
+    k = v[(i + 2) % 3] ;
+    t->A[i] = Y[j] - Y[k] ;
+    t->B[i] = X[k] - X[j] ;
+    t->C[i] = -(t->A[i] * X[j] + t->B[i] * Y[j]) ;
+    // top edge : horizontal, going right ... left edge : going up
+    t->bias[i] = ((t->A[i] > 0) || ((t->A[i] == 0) && (t->B[i] > 0))) ? 0 : -1 ;
+  }
+
+  // pixels whose centers can be inside, clipped to the buffer
+  xlo = X[0] ; xhi = X[0] ; ylo = Y[0] ; yhi = Y[0] ;
+  for (i = 1 ; i < 3 ; i++) {
+    if (X[i] < xlo) xlo = X[i] ;
+    if (X[i] > xhi) xhi = X[i] ;
+    if (Y[i] < ylo) ylo = Y[i] ;
+    if (Y[i] > yhi) yhi = Y[i] ;
+  }
+  t->small = ((xhi - xlo) < MM_SIMD_SPAN) && ((yhi - ylo) < MM_SIMD_SPAN) ;
+
+  // smallest c with c*16 + 8 >= xlo, largest with c*16 + 8 <= xhi
+  t->xmin = (xlo - MM_SUBPIXEL/2 + MM_SUBPIXEL - 1 < 0) ? 0 : (int)((xlo - MM_SUBPIXEL/2 + MM_SUBPIXEL - 1) >> MM_SUBPIXEL_BITS) ;
+  t->rmin = (ylo - MM_SUBPIXEL/2 + MM_SUBPIXEL - 1 < 0) ? 0 : (int)((ylo - MM_SUBPIXEL/2 + MM_SUBPIXEL - 1) >> MM_SUBPIXEL_BITS) ;
+  t->xmax = (xhi - MM_SUBPIXEL/2 >= (long long)Xx_Pix_width * MM_SUBPIXEL) ? Xx_Pix_width - 1 : (int)((xhi - MM_SUBPIXEL/2) >> MM_SUBPIXEL_BITS) ;
+  t->rmax = (yhi - MM_SUBPIXEL/2 >= (long long)Xx_Pix_height * MM_SUBPIXEL) ? Xx_Pix_height - 1 : (int)((yhi - MM_SUBPIXEL/2) >> MM_SUBPIXEL_BITS) ;
+  if (t->xmin < Clip_c0) t->xmin = Clip_c0 ;
+  if (t->rmin < Clip_r0) t->rmin = Clip_r0 ;
+  if (t->xmax > Clip_c1) t->xmax = Clip_c1 ;
+  if (t->rmax > Clip_r1) t->rmax = Clip_r1 ;
+  if ((t->xmin > t->xmax) || (t->rmin > t->rmax)) return 0 ;
+
+  t->flat = (unsigned int)Current_Color_Pixel ;
+  t->shaded = (rgb != NULL) ;
+  if (t->shaded) {
+    for (k = 0 ; k < 3 ; k++) {
+      for (i = 0 ; i < 3 ; i++) w[i] = rgb[v[i]][k] ;
+      Mm_Plane (t, area, w, p) ;
+      t->c0[k]  = (float)p[0] ;
+      t->cdx[k] = (float)p[1] ;
+      t->cdy[k] = (float)p[2] ;
+    }
+  }
+
+  t->runs = NULL ;
+  t->depth = (z != NULL) ;
+  if (t->depth) {
+    for (i = 0 ; i < 3 ; i++) w[i] = z[v[i]] ;
+    Mm_Plane (t, area, w, p) ;
+    t->z0 = p[0] ; t->zdx = p[1] ; t->zdy = p[2] ;
+    t->zlo = z[0] ;
+    if (z[1] < t->zlo) t->zlo = z[1] ;
+    if (z[2] < t->zlo) t->zlo = z[2] ;
+  }
+
+  return 1 ;
+}
+
+
+
+static unsigned int Mm_Shade (const Mm_Triangle *t, int c, int r)
+// interpolated color of pixel (c,r)
+{
+  float f[3] ;
+  int k, n[3] ;
+
+  for (k = 0 ; k < 3 ; k++) {
+    f[k] = t->c0[k] + t->cdx[k] * (c - t->xmin) + t->cdy[k] * (r - t->rmin) ;
+    n[k] = (int)f[k] ;
+    if (n[k] < 0) n[k] = 0 ; else if (n[k] > 255) n[k] = 255 ;
+  }
+  return (n[0] << 16) | (n[1] << 8) | n[2] ;
+}
+
+
+
+static void Mm_Raster_Triangle_Scalar (const Mm_Triangle *t)
+// one pixel at a time in 64 bit arithmetic ... for triangles
+// too large for the 32 bit path and for machines without SSE2
+{
+  long long e[3], erow[3], sx[3] ;
+  long long pcx = (long long)t->xmin * MM_SUBPIXEL + MM_SUBPIXEL/2 ;
+  long long pcy = (long long)t->rmin * MM_SUBPIXEL + MM_SUBPIXEL/2 ;
+  unsigned int *p ;
+  int c, r, i ;
+  int a = Current_Alpha_Weight ;
+
+  for (i = 0 ; i < 3 ; i++) {
+    erow[i] = t->A[i] * pcx + t->B[i] * pcy + t->C[i] + t->bias[i] ;
+    sx[i] = t->A[i] * MM_SUBPIXEL ;
+  }
+
+  for (r = t->rmin ; r <= t->rmax ; r++) {
+    e[0] = erow[0] ; e[1] = erow[1] ; e[2] = erow[2] ;
+    p = &MM_PIXEL(t->xmin, r) ;
+    for (c = t->xmin ; c <= t->xmax ; c++, p++) {
+      if ((e[0] | e[1] | e[2]) >= 0) {
+        Mm_Put (p, t->shaded ? Mm_Shade (t, c, r) : t->flat, a) ;
+      }
+      e[0] += sx[0] ; e[1] += sx[1] ; e[2] += sx[2] ;
+    }
+    for (i = 0 ; i < 3 ; i++) erow[i] += t->B[i] * MM_SUBPIXEL ;
+  }
+}
+
+
+
+#ifdef __SSE2__
+
+static void Mm_Raster_Triangle_Blocks (const Mm_Triangle *t)
+// 4x4 blocks, 32 bit edge functions, 4 pixels per SSE2 operation
+{
+  int sx[3], sy[3], eblock[3], erow[3], lo[3], hi[3] ;
+  int bx, by, r, c, i, k, mask, full, ncol ;
+  long long pcx = (long long)t->xmin * MM_SUBPIXEL + MM_SUBPIXEL/2 ;
+  long long pcy = (long long)t->rmin * MM_SUBPIXEL + MM_SUBPIXEL/2 ;
+  __m128i step[3], e, any, flat ;
+  __m128 lane, rgbx[3], f ;
+  unsigned int *p ;
+  unsigned int pix[4] ;
+  int a = Current_Alpha_Weight ;
+  __m128i wa = _mm_set1_epi16 ((short)a) ;
+
+  for (i = 0 ; i < 3 ; i++) {
+    sx[i] = (int)(t->A[i] * MM_SUBPIXEL) ;
+    sy[i] = (int)(t->B[i] * MM_SUBPIXEL) ;
+    erow[i] = (int)(t->A[i] * pcx + t->B[i] * pcy + t->C[i] + t->bias[i]) ;
+    step[i] = _mm_setr_epi32 (0, sx[i], 2*sx[i], 3*sx[i]) ;
+    // range of E over a 4x4 block, relative to its first pixel
+    lo[i] = (sx[i] < 0 ? 3*sx[i] : 0) + (sy[i] < 0 ? 3*sy[i] : 0) ;
+    hi[i] = (sx[i] > 0 ? 3*sx[i] : 0) + (sy[i] > 0 ? 3*sy[i] : 0) ;
+  }
+  flat = _mm_set1_epi32 ((int)t->flat) ;
+  lane = _mm_setr_ps (0, 1, 2, 3) ;
+  for (k = 0 ; k < 3 ; k++) {
+    rgbx[k] = _mm_mul_ps (lane, _mm_set1_ps (t->cdx[k])) ;
+  }
+
+  for (by = t->rmin ; by <= t->rmax ; by += 4) {
+    for (i = 0 ; i < 3 ; i++) eblock[i] = erow[i] ;
+
+    for (bx = t->xmin ; bx <= t->xmax ; bx += 4) {
+
+      // trivial reject and accept on the whole block
+      if ((eblock[0] + hi[0] < 0) || (eblock[1] + hi[1] < 0) || (eblock[2] + hi[2] < 0)) goto NEXT_BLOCK ;
+      full = (eblock[0] + lo[0] >= 0) && (eblock[1] + lo[1] >= 0) && (eblock[2] + lo[2] >= 0)
+             && (bx + 3 <= t->xmax) && (by + 3 <= t->rmax) ;
+      ncol = t->xmax - bx + 1 ;
+      if (ncol > 4) ncol = 4 ;
+
+      for (r = by ; (r < by + 4) && (r <= t->rmax) ; r++) {
+        if (full) {
+          mask = 0xf ;
+        } else {
+          any = _mm_setzero_si128() ;
+          for (i = 0 ; i < 3 ; i++) {
+            e = _mm_add_epi32 (_mm_set1_epi32 (eblock[i] + (r - by) * sy[i]), step[i]) ;
+            any = _mm_or_si128 (any, e) ;
+          }
+          // a lane is inside when none of its three values is negative
+          mask = ~_mm_movemask_ps (_mm_castsi128_ps (any)) & ((1 << ncol) - 1) ;
+          if (mask == 0) continue ;
+        }
+
+        p = &MM_PIXEL(bx, r) ;
+        if (!t->shaded) {
+          if ((mask == 0xf) && (a == 256)) { _mm_storeu_si128 ((__m128i *)p, flat) ; continue ; }
+          if (mask == 0xf) { _mm_storeu_si128 ((__m128i *)p, Mm_Mix4 (flat, _mm_loadu_si128 ((__m128i *)p), wa, wa)) ; continue ; }
+          for (c = 0 ; c < 4 ; c++) if (mask & (1 << c)) Mm_Put (p + c, t->flat, a) ;
+          continue ;
+        }
+
+        // Gouraud : the three channel planes for these 4 pixels
+        {
+          __m128i ch[3] ;
+          for (k = 0 ; k < 3 ; k++) {
+            f = _mm_set1_ps (t->c0[k] + t->cdx[k] * (bx - t->xmin) + t->cdy[k] * (r - t->rmin)) ;
+            f = _mm_add_ps (f, rgbx[k]) ;
+            f = _mm_min_ps (_mm_max_ps (f, _mm_setzero_ps()), _mm_set1_ps (255.0f)) ;
+            ch[k] = _mm_cvttps_epi32 (f) ;
+          }
+          e = _mm_or_si128 (_mm_or_si128 (_mm_slli_epi32 (ch[0], 16), _mm_slli_epi32 (ch[1], 8)), ch[2]) ;
+        }
+        if (mask == 0xf) {
+          if (a < 256) e = Mm_Mix4 (e, _mm_loadu_si128 ((__m128i *)p), wa, wa) ;
+          _mm_storeu_si128 ((__m128i *)p, e) ;
+          continue ;
+        }
+        // a partial block may end at the edge of the buffer, so
+        // its pixels are not loaded 4 at a time
+        _mm_storeu_si128 ((__m128i *)pix, e) ;
+        for (c = 0 ; c < 4 ; c++) if (mask & (1 << c)) Mm_Put (p + c, pix[c], a) ;
+      }
+
+    NEXT_BLOCK :
+      for (i = 0 ; i < 3 ; i++) eblock[i] += 4 * sx[i] ;
+    }
+
+    for (i = 0 ; i < 3 ; i++) erow[i] += 4 * sy[i] ;
+  }
+}
+
+#endif
+
+
+
+static void Mm_Touch_Ztile (int tx, int ty)
+// give a stale tile the depth of an empty pixel
+{
+  int c, r ;
+  int c0 = tx << MM_ZTILE_BITS ;
+  int r0 = ty << MM_ZTILE_BITS ;
+  int c1 = c0 + MM_ZTILE - 1 ;
+  int r1 = r0 + MM_ZTILE - 1 ;
+
+  if (c1 >= Xx_Pix_width) c1 = Xx_Pix_width - 1 ;
+  if (r1 >= Xx_Pix_height) r1 = Xx_Pix_height - 1 ;
+  for (r = r0 ; r <= r1 ; r++) {
+    for (c = c0 ; c <= c1 ; c++) MM_DEPTH(c,r) = MM_ZFAR ;
+  }
+  Mm_Ztile_stale[ty * Mm_Ztiles_wide + tx] = 0 ;
+}
+
+
+
+static void Mm_Update_Ztile_Max (int tx, int ty)
+{
+  int c, r ;
+  int c0 = tx << MM_ZTILE_BITS ;
+  int r0 = ty << MM_ZTILE_BITS ;
+  int c1 = c0 + MM_ZTILE - 1 ;
+  int r1 = r0 + MM_ZTILE - 1 ;
+  float m = -MM_ZFAR ;
+
+  if (c1 >= Xx_Pix_width) c1 = Xx_Pix_width - 1 ;
+  if (r1 >= Xx_Pix_height) r1 = Xx_Pix_height - 1 ;
+  for (r = r0 ; r <= r1 ; r++) {
+    for (c = c0 ; c <= c1 ; c++) if (MM_DEPTH(c,r) > m) m = MM_DEPTH(c,r) ;
+  }
+  Mm_Ztile_max[ty * Mm_Ztiles_wide + tx] = m ;
+}
+
+
+
+static void Mm_Depth_Run (Xx_Batch *b, int *rs, int *re, int r, int c0, int c1)
+// adds the passing pixels c0..c1 of row r to the open run of that
+// row of tiles, which is sent first when the two do not touch ;
+// rs[i] > re[i] when row i has no open run
+{
+  int i = r & (MM_ZTILE - 1) ;
+
+  if ((rs[i] <= re[i]) && (re[i] + 1 == c0)) { re[i] = c1 ; return ; }
+  if (rs[i] <= re[i]) b->n = Xx_Add_Run (b->rect, b->n, rs[i], re[i], Xx_Pix_height - 1 - r) ;
+  rs[i] = c0 ;
+  re[i] = c1 ;
+}
+
+
+
+static void Mm_Raster_Triangle_Depth (const Mm_Triangle *t)
+// Depth tested, one depth tile at a time.  A tile the triangle
+// misses, or where it is behind everything already drawn, costs
+// only a few operations ; a tile fully inside the triangle needs
+// no edge tests, and with SSE2 is depth tested 4 pixels at a time.
+// A pixel is drawn when its depth is less than the stored one.
+// For X (t->runs) the pixels that pass are joined into runs across
+// each row of tiles instead, and sent as rectangles.
+{
+  long long pcx, pcy, e[3], erow[3], sx[3], lo, hi, d ;
+  double zmin ;
+  float zf ;
+  float *zp ;
+  unsigned int *p ;
+  int tx, ty, c0, c1, r0, r1, r, i, k, n, inside, drawn, pass, run ;
+  int rs[MM_ZTILE], re[MM_ZTILE] ;
+  int a = Current_Alpha_Weight ;
+
+  for (i = 0 ; i < 3 ; i++) sx[i] = t->A[i] * MM_SUBPIXEL ;
+
+  for (ty = t->rmin >> MM_ZTILE_BITS ; ty <= t->rmax >> MM_ZTILE_BITS ; ty++) {
+    r0 = ty << MM_ZTILE_BITS ;
+    r1 = r0 + MM_ZTILE - 1 ;
+    if (r0 < t->rmin) r0 = t->rmin ;
+    if (r1 > t->rmax) r1 = t->rmax ;
+    for (i = 0 ; i < MM_ZTILE ; i++) { rs[i] = 0 ; re[i] = -1 ; }
+
+    for (tx = t->xmin >> MM_ZTILE_BITS ; tx <= t->xmax >> MM_ZTILE_BITS ; tx++) {
+      c0 = tx << MM_ZTILE_BITS ;
+      c1 = c0 + MM_ZTILE - 1 ;
+      if (c0 < t->xmin) c0 = t->xmin ;
+      if (c1 > t->xmax) c1 = t->xmax ;
+
+      // range of each edge function over the pixel centers of the tile
+      pcx = (long long)c0 * MM_SUBPIXEL + MM_SUBPIXEL/2 ;
+      pcy = (long long)r0 * MM_SUBPIXEL + MM_SUBPIXEL/2 ;
+      inside = 1 ;
+      for (i = 0 ; i < 3 ; i++) {
+        erow[i] = t->A[i] * pcx + t->B[i] * pcy + t->C[i] + t->bias[i] ;
+        lo = erow[i] ; hi = erow[i] ;
+        d = sx[i] * (c1 - c0) ;
+        if (d < 0) lo += d ; else hi += d ;
+        d = t->B[i] * MM_SUBPIXEL * (r1 - r0) ;
+        if (d < 0) lo += d ; else hi += d ;
+        if (hi < 0) goto NEXT_TILE ;
+        if (lo < 0) inside = 0 ;
+      }
+
+      // the nearest the triangle comes within the tile
+      zmin = t->z0 + t->zdx * (c0 - t->xmin) + t->zdy * (r0 - t->rmin) ;
+      if (t->zdx < 0) zmin += t->zdx * (c1 - c0) ;
+      if (t->zdy < 0) zmin += t->zdy * (r1 - r0) ;
+      if (zmin < t->zlo) zmin = t->zlo ;
+      if (zmin >= Mm_Ztile_max[ty * Mm_Ztiles_wide + tx]) goto NEXT_TILE ;
+
+      if (Mm_Ztile_stale[ty * Mm_Ztiles_wide + tx]) Mm_Touch_Ztile (tx, ty) ;
+
+      drawn = 0 ;
+      n = c1 - c0 + 1 ;
+      for (r = r0 ; r <= r1 ; r++) {
+        double zrow = t->z0 + t->zdx * (c0 - t->xmin) + t->zdy * (r - t->rmin) ;
+        p = (t->runs == NULL) ? &MM_PIXEL(c0,r) : NULL ;
+        zp = &MM_DEPTH(c0,r) ;
+        k = 0 ;
+
+#ifdef __SSE2__
+        if (inside && !t->shaded && (t->runs == NULL)) {
+          __m128 zlane = _mm_mul_ps (_mm_setr_ps (0, 1, 2, 3), _mm_set1_ps ((float)t->zdx)) ;
+          __m128i flat = _mm_set1_epi32 ((int)t->flat) ;
+          __m128i wa = _mm_set1_epi16 ((short)a) ;
+          __m128 zv, old, m ;
+          __m128i mi, pix, src ;
+          for ( ; k + 4 <= n ; k += 4) {
+            zv = _mm_add_ps (_mm_set1_ps ((float)(zrow + t->zdx * k)), zlane) ;
+            old = _mm_loadu_ps (zp + k) ;
+            m = _mm_cmplt_ps (zv, old) ;
+            _mm_storeu_ps (zp + k, _mm_or_ps (_mm_and_ps (m, zv), _mm_andnot_ps (m, old))) ;
+            mi = _mm_castps_si128 (m) ;
+            pix = _mm_loadu_si128 ((__m128i *)(p + k)) ;
+            src = (a < 256) ? Mm_Mix4 (flat, pix, wa, wa) : flat ;
+            _mm_storeu_si128 ((__m128i *)(p + k), _mm_or_si128 (_mm_and_si128 (mi, src), _mm_andnot_si128 (mi, pix))) ;
+            drawn |= _mm_movemask_ps (m) ;
+          }
+        }
+#endif
+
+        for (i = 0 ; i < 3 ; i++) e[i] = erow[i] + sx[i] * k ;
+        if (t->runs == NULL) {
+          for ( ; k < n ; k++) {
+            if (inside || ((e[0] | e[1] | e[2]) >= 0)) {
+              zf = (float)(zrow + t->zdx * k) ;
+              if (zf < zp[k]) {
+                zp[k] = zf ;
+                Mm_Put (p + k, t->shaded ? Mm_Shade (t, c0 + k, r) : t->flat, a) ;
+                drawn = 1 ;
+              }
+            }
+            e[0] += sx[0] ; e[1] += sx[1] ; e[2] += sx[2] ;
+          }
+        } else {
+          run = -1 ; // where the run of passing pixels began
+          for ( ; k < n ; k++) {
+            pass = 0 ;
+            if (inside || ((e[0] | e[1] | e[2]) >= 0)) {
+              zf = (float)(zrow + t->zdx * k) ;
+              if (zf < zp[k]) { zp[k] = zf ; pass = 1 ; }
+            }
+            if (pass && (run < 0)) run = k ;
+            else if (!pass && (run >= 0)) { Mm_Depth_Run (t->runs, rs, re, r, c0 + run, c0 + k - 1) ; run = -1 ; drawn = 1 ; }
+            e[0] += sx[0] ; e[1] += sx[1] ; e[2] += sx[2] ;
+          }
+          if (run >= 0) { Mm_Depth_Run (t->runs, rs, re, r, c0 + run, c1) ; drawn = 1 ; }
+        }
+
+        for (i = 0 ; i < 3 ; i++) erow[i] += t->B[i] * MM_SUBPIXEL ;
+      }
+
+      // depths only go down, but a tight bound rejects more
+      if (drawn) Mm_Update_Ztile_Max (tx, ty) ;
+
+    NEXT_TILE : ;
+    }
+
+    if (t->runs != NULL) {
+      for (r = r0 ; r <= r1 ; r++) {
+        i = r & (MM_ZTILE - 1) ;
+        if (rs[i] <= re[i]) t->runs->n = Xx_Add_Run (t->runs->rect, t->runs->n, rs[i], re[i], Xx_Pix_height - 1 - r) ;
+      }
+    }
+  }
+}
+
+
+
+static void Mm_Raster_Triangle (const Mm_Triangle *t)
+{
+  if (t->depth) { Mm_Raster_Triangle_Depth (t) ; return ; }
+#ifdef __SSE2__
+  if (t->small) { Mm_Raster_Triangle_Blocks (t) ; return ; }
+#endif
+  Mm_Raster_Triangle_Scalar (t) ;
+}
+
+
+
+int Fill_Triangle_Rgb_M (double x[3], double y[3], double rgb[3][3])
+{
+  Mm_Triangle t ;
+  double row[3], c[3][3] ;
+  int i, k ;
+
+  for (i = 0 ; i < 3 ; i++) {
+    row[i] = Xx_Pix_height - 1 - y[i] ;
+    // the same scaling as Set_Color_Rgb_DX, the shader clamps to 255
+    for (k = 0 ; k < 3 ; k++) {
+      c[i][k] = rgb[i][k] ;
+      if (c[i][k] < 0.0) c[i][k] = 0.0 ; else if (c[i][k] > 1.0) c[i][k] = 1.0 ;
+      c[i][k] *= 256 ;
+    }
+  }
+
+  if (Mm_Setup_Triangle (&t, x, row, c, NULL)) Mm_Raster_Triangle (&t) ;
+
+  return 1 ;
+}
+
+
+
+int Fill_Triangle_M (double Dx1, double Dy1, 
+                     double Dx2, double Dy2,
+                     double Dx3, double Dy3)
+// the same truncated corners as Fill_Triangle_X
+{
+  Mm_Triangle t ;
+  double x[3], row[3] ;
+
+  if (Mm_Antialias) {
+    x[0] = Dx1 ; row[0] = Xx_Pix_height - 1 - Dy1 ;
+    x[1] = Dx2 ; row[1] = Xx_Pix_height - 1 - Dy2 ;
+    x[2] = Dx3 ; row[2] = Xx_Pix_height - 1 - Dy3 ;
+    return Mm_Cover_Polygon (x, row, 3) ;
+  }
+
+  x[0] = (int)Dx1 ; row[0] = Xx_Pix_height - 1 - (int)Dy1 ;
+  x[1] = (int)Dx2 ; row[1] = Xx_Pix_height - 1 - (int)Dy2 ;
+  x[2] = (int)Dx3 ; row[2] = Xx_Pix_height - 1 - (int)Dy3 ;
+
+  if (Mm_Setup_Triangle (&t, x, row, NULL, NULL)) Mm_Raster_Triangle (&t) ;
+
+  return 1 ;
+}
+
+
+
+static int Mm_Fill_Triangle_3d (double x[3], double row[3], double z[3], Xx_Batch *runs)
+// Fill_Triangle_3d_M, and on X the depth test of Xx_Fill_3d, whose
+// pixels go to runs ; the depth buffer is allocated on first use
+// return 0 if it can't be, else 1
+{
+  Mm_Triangle t ;
+
+  if ((Mm_Zbuffer == NULL) && !Mm_Alloc_Depth (Xx_Pix_width, Xx_Pix_height)) return 0 ;
+
+  if (Mm_Setup_Triangle (&t, x, row, NULL, z)) {
+    t.runs = runs ;
+    Mm_Raster_Triangle (&t) ;
+  }
+
+  return 1 ;
+}
+
+
+
+int Fill_Triangle_3d_M (double x0, double y0, double z0,
+                        double x1, double y1, double z1,
+                        double x2, double y2, double z2)
+{
+  double x[3], row[3], z[3] ;
+
+  x[0] = x0 ; row[0] = Xx_Pix_height - 1 - y0 ; z[0] = z0 ;
+  x[1] = x1 ; row[1] = Xx_Pix_height - 1 - y1 ; z[1] = z1 ;
+  x[2] = x2 ; row[2] = Xx_Pix_height - 1 - y2 ; z[2] = z2 ;
+
+  return Mm_Fill_Triangle_3d (x, row, z, NULL) ;
+}
+
+
+
+int Fill_Polygon_3d_M (double *x, double *y, double *z, double Dnpts)
+// a fan from vertex 0 ... the top-left rule keeps its inner
+// edges from being drawn twice
+{
+  int npts = (int)Dnpts ;
+  int i ;
+
+  if (npts < 3) return 0 ;
+
+  for (i = 1 ; i < npts - 1 ; i++) {
+    if (!Fill_Triangle_3d_M (x[0],y[0],z[0], x[i],y[i],z[i], x[i+1],y[i+1],z[i+1])) return 0 ;
+  }
+
+  return 1 ;
+}
+
+
+
+int Circle_M (double Da, double Db, double Dr)
+// the same pixels as Circle_X, straight into the buffer
+{
+ int a = (int)Da ;
+ int b = (int)Db ;
+ int r = (int)Dr ;
+
+ int x,y,e,e1,e2 ;
+ int oct[8], k, px, py ;
+ unsigned int c = (unsigned int)Current_Color_Pixel ;
+ int alpha = Current_Alpha_Weight ;
+
+ if (Current_Pen_Width > 1) {
+   double hw = 0.5 * Current_Pen_Width ;
+   if (Mm_Antialias) return Mm_Ring (Da, Xx_Pix_height - 1 - Db, Dr - hw, Dr + hw) ;
+   return Mm_Ring (a, Xx_Pix_height - 1 - b, r - hw, r + hw) ;
+ }
+
+ if (Mm_Antialias) {
+   Mm_Wu_Circle (Da, Xx_Pix_height - 1 - Db, Dr) ;
+   return 1 ;
+ }
+
+ if (r < 0) return 1 ;
+ Circle_Octants (a, b, r, oct) ;
+
+ x = r ;
+ y = 0 ;
+ e = 0;
+
+ while (x >= y) {
+
+       for (k = 0 ; k < 8 ; k++) {
+         if (oct[k] == 0) continue ;
+         CIRCLE_OCTANT_POINT(k, px, py) ;
+         if ((oct[k] == 2) &&
+             ((px < Clip_c0) || (px > Clip_c1) ||
+              (Xx_Pix_height - 1 - py < Clip_r0) || (Xx_Pix_height - 1 - py > Clip_r1))) continue ;
+         Mm_Put (&MM_PIXEL(px, Xx_Pix_height - 1 - py), c, alpha) ;
+       }
+
+       e1 =  e + y + y + 1 ;
+       e2 = e1 - x - x + 1 ;
+       y  =  y + 1 ;
+
+       if ( abs(e2) < abs(e1) ) {
+              x = x - 1 ;
+              e = e2 ;
+       } else e = e1 ;
+
+     } 
+
+  return 1 ; 
+} 
+
+
+
+int Fill_Circle_M (double Da, double Db, double Dr)
+// the same pixels as Fill_Circle_X
+{
+ int a = (int)Da ;
+ int b = (int)Db ;
+ int r = (int)Dr ;
+
+ int x,y,e,e1,e2 ;
+
+ if (Mm_Antialias) {
+   Mm_Fill_Circle_AA (Da, Xx_Pix_height - 1 - Db, Dr) ;
+   return 1 ;
+ }
+
+ if (Clip_Out (a - r, Xx_Pix_height - 1 - b - r, a + r, Xx_Pix_height - 1 - b + r)) return 1 ;
+
+ x = r ;
+ y = 0 ;
+ e = 0;
+
+ while (x >= y) {
+
+       Horizontal_Single_Pixel_Line_M (a-x, a+x, b+y) ;
+       Horizontal_Single_Pixel_Line_M (a-x, a+x, b-y) ;
+
+       Horizontal_Single_Pixel_Line_M (a-y, a+y, b+x) ;
+       Horizontal_Single_Pixel_Line_M (a-y, a+y, b-x) ;
+
+       e1 =  e + y + y + 1 ;
+       e2 = e1 - x - x + 1 ;
+       y  =  y + 1 ;
+
+       if ( abs(e2) < abs(e1) ) {
+              x = x - 1 ;
+              e = e2 ;
+       } else e = e1 ;
+
+     } 
+
+  return 1 ; 
+} 
+
+
+
+static void Mm_Ellipse_Span (int x0, int x1, int row, void *ctx)
+{
+  Mm_Span (x0, x1, row) ;
+}
+
+
+
+static int Mm_Ellipse (double Da, double Db, double Drx, double Dry, int fill)
+// Ellipse_M and Fill_Ellipse_M : the runs of Ellipse_Spans as spans
+{
+  return Ellipse_Spans (Da, Db, Drx, Dry, fill, Mm_Ellipse_Span, NULL) ;
+}
+
+
+
+int Ellipse_M (double Da, double Db, double Drx, double Dry)
+// a wide pen strokes the ellipse as a closed polygon with chords
+// within 1/4 pixel of it, the points turned as in sector
+{
+  if (Current_Pen_Width > 1) {
+    double x[SECTOR_MAX_STEPS], y[SECTOR_MAX_STEPS] ;
+    double rm, step, c, s, u, v, t ;
+    int n, k ;
+
+    rm = (fabs(Drx) > fabs(Dry)) ? fabs(Drx) : fabs(Dry) ;
+    step = (rm > 0.25) ? 2*acos(1 - 0.25/rm) : M_PI/2 ;
+    n = (2*M_PI >= step*SECTOR_MAX_STEPS) ? SECTOR_MAX_STEPS : (int)ceil(2*M_PI/step) ;
+    if (n < 4) n = 4 ;
+    c = cos(2*M_PI/n) ;
+    s = sin(2*M_PI/n) ;
+    u = 1 ; v = 0 ;
+    for (k = 0 ; k < n ; k++) {
+      x[k] = Da + Drx*u ;
+      y[k] = Db + Dry*v ;
+      t = u*c - v*s ;
+      v = u*s + v*c ;
+      u = t ;
+    }
+    return Mm_Stroke (x, y, n, 1) ;
+  }
+
+  return Mm_Ellipse (Da, Db, Drx, Dry, 0) ;
+}
+
+
+
+int Fill_Ellipse_M (double Da, double Db, double Drx, double Dry)
+{
+  return Mm_Ellipse (Da, Db, Drx, Dry, 1) ;
+}
+
+
+
+static void Mm_Half_Row (double c, double s, double t, double dy, double cx,
+                         int lo, int hi, int keep, int *c0, int *c1)
+// The columns of lo..hi to the left of the ray from the center in the
+// direction (c,s), c*dy - s*dx >= 0 (keep = 1), or to its right (keep
+// = 0), as *c0..*c1 ; empty if *c0 > *c1.  dy is the height of the row
+// above the center and t = c/s.  Both sides use the same bound, so the
+// sectors on the two sides of a ray split every row exactly.
+{
+  double b ;
+  int e ;
+
+  *c0 = lo ; *c1 = hi ;
+  if (s == 0) {
+    if ((c*dy >= 0) != keep) *c0 = hi + 1 ;
+    return ;
+  }
+  b = cx + t*dy ;
+  if (b < lo - 1) b = lo - 1 ; else if (b > hi + 1) b = hi + 1 ;
+  if (s > 0) {
+    e = (int)floor(b) ;
+    if (keep) { if (e < hi) *c1 = e ; } else { if (e + 1 > lo) *c0 = e + 1 ; }
+  } else {
+    e = (int)ceil(b) ;
+    if (keep) { if (e > lo) *c0 = e ; } else { if (e - 1 < hi) *c1 = e - 1 ; }
+  }
+}
+
+
+
+static void Mm_Span_Except (int c0, int c1, int row, int skip)
+// Mm_Span of c0..c1 leaving out column skip
+{
+  if ((skip < c0) || (skip > c1)) { if (c0 <= c1) Mm_Span (c0, c1, row) ; return ; }
+  if (c0 < skip) Mm_Span (c0, skip - 1, row) ;
+  if (skip < c1) Mm_Span (skip + 1, c1, row) ;
+}
+
+
+
+int Fill_Sector_M (double Da, double Db, double Dr,
+                   double start_radians, double end_radians)
+// The pixels whose centers are in the circle (integer coordinates at
+// pixel centers, as in Fill_Circle_M) and counterclockwise from the ray
+// at start_radians to the one at end_radians.  Each row is cut by the
+// circle and by the two half planes of the rays : both of them for a
+// sector up to half the circle, either one for a bigger one.  A pixel
+// on a ray belongs to the sector that starts there, and the center to
+// the one that holds the direction of angle 0, so the sectors of a pie
+// chart cover each pixel once.  Antialiased, the arc is tessellated
+// (sector) and filled with exact coverage.
+{
+  double delta = end_radians - start_radians ;
+  double cs, ss, ce, se, ts, te, dy, w, top, bot ;
+  int y, ylo, yhi, row, lo, hi, a0, a1, b0, b1, c0, skip, in0, wide ;
+
+  if ((delta < 0) || (delta > 2*M_PI)) { printf("Sector flaw\n") ; return 1 ; }
+  if ((delta == 0) || (Dr < 0)) return 1 ;
+
+  if (Mm_Antialias) {
+    double x[SECTOR_MAX_STEPS+2], yy[SECTOR_MAX_STEPS+2], r[SECTOR_MAX_STEPS+2] ;
+    int n, k ;
+    n = sector (Da, Db, Dr, start_radians, end_radians, x, yy) ;
+    for (k = 0 ; k < n ; k++) {
+      x[k] += 0.5 ;
+      r[k] = Xx_Pix_height - 0.5 - yy[k] ;
+    }
+    return Mm_Cover_Polygon (x, r, n) ;
+  }
+
+  cs = cos(start_radians) ; ss = sin(start_radians) ;
+  ce = cos(end_radians) ;   se = sin(end_radians) ;
+  ts = (ss != 0) ? cs / ss : 0 ;
+  te = (se != 0) ? ce / se : 0 ;
+  wide = (delta > M_PI) ;
+
+  // the center pixel, if there is one, goes to the sector that holds
+  // the direction (1,0), judged by the same two tests as the rows
+  skip = -1 ;
+  in0 = 0 ;
+  if ((Da == floor(Da)) && (Db == floor(Db)) && (Db >= 0) && (Db < Xx_Pix_height)
+      && (Da >= 0) && (Da < Xx_Pix_width)) {
+    skip = (int)Da ;
+    in0 = wide ? ((ss <= 0) || (se > 0)) : ((ss <= 0) && (se > 0)) ;
+    if (delta >= 2*M_PI) in0 = 1 ;
+  }
+
+  // only the rows of the sector's bounding box, from its ends, the
+  // center, and the top and bottom of the circle if the arc passes them
+  bot = Dr * ((ss < se) ? ss : se) ;
+  top = Dr * ((ss > se) ? ss : se) ;
+  if (bot > 0) bot = 0 ;
+  if (top < 0) top = 0 ;
+  w = M_PI/2 - start_radians ;
+  if (w - 2*M_PI*floor(w/(2*M_PI)) <= delta) top = Dr ;
+  w = 3*M_PI/2 - start_radians ;
+  if (w - 2*M_PI*floor(w/(2*M_PI)) <= delta) bot = -Dr ;
+  ylo = (Db + bot - 1 < 0) ? 0 : (int)ceil(Db + bot - 1) ;
+  yhi = (Db + top + 1 >= Xx_Pix_height) ? Xx_Pix_height - 1 : (int)floor(Db + top + 1) ;
+
+  for (y = ylo ; y <= yhi ; y++) {
+    dy = y - Db ;
+    w = Dr*Dr - dy*dy ;
+    if (w < 0) continue ;
+    w = sqrt(w) ;
+    lo = (Da - w < 0) ? 0 : (int)ceil(Da - w) ;
+    hi = (Da + w >= Xx_Pix_width) ? Xx_Pix_width - 1 : (int)floor(Da + w) ;
+    if (lo > hi) continue ;
+    row = Xx_Pix_height - 1 - y ;
+
+    if (delta >= 2*M_PI) {
+      Mm_Span (lo, hi, row) ;
+      continue ;
+    }
+
+    // left of the start ray, cs*dy - ss*dx >= 0 ; right of the end
+    // ray, ce*dy - se*dx < 0
+    Mm_Half_Row (cs, ss, ts, dy, Da, lo, hi, 1, &a0, &a1) ;
+    Mm_Half_Row (ce, se, te, dy, Da, lo, hi, 0, &b0, &b1) ;
+
+    c0 = (dy == 0) ? skip : -1 ;
+    if (!wide) {
+      Mm_Span_Except ((a0 > b0) ? a0 : b0, (a1 < b1) ? a1 : b1, row, c0) ;
+    } else if ((a0 > a1) || (b0 > b1) || ((b0 <= a1 + 1) && (a0 <= b1 + 1))) {
+      // one span : either part alone, or the two overlapping or touching
+      if (a0 > a1) { a0 = b0 ; a1 = b1 ; }
+      else if (b0 <= b1) { if (b0 < a0) a0 = b0 ; if (b1 > a1) a1 = b1 ; }
+      Mm_Span_Except (a0, a1, row, c0) ;
+    } else {
+      Mm_Span_Except (a0, a1, row, c0) ;
+      Mm_Span_Except (b0, b1, row, c0) ;
+    }
+    if ((c0 >= 0) && in0 && (c0 >= lo) && (c0 <= hi)) Mm_Span (c0, c0, row) ;
+  }
+
+  return 1 ;
+}
+
+
+
+int Font_Pixel_Height_M ()
+// the built in font, with the metrics of the 10x20 X font
+{
+     return FONT_HEIGHT ;
+}
+
+
+
+int String_Pixel_Width_M (const void *s)
+{
+     return FONT_WIDTH * (int)strlen((char *)s) ;
+}
+
+
+
+int String_Pixel_Widths_M (int n, const void *strings, int *widths)
+{
+  const char **s = (const char **)strings ;
+  int k ;
+
+  if (n < 0) return 0 ;
+  for (k = 0 ; k < n ; k++) widths[k] = FONT_WIDTH * (int)strlen (s[k]) ;
+  return 1 ;
+}
+
+
+
+static void Mm_Glyph (const short *q, int nq, int x, int top)
+// the nq rectangles q of a glyph as spans, its cell's top left corner
+// at column x, row top
+{
+  int k, x0, x1, r0, r1, row ;
+
+  for (k = 0 ; k < nq ; k++, q += 4) {
+    x0 = x + q[0] ; x1 = x0 + q[2] - 1 ;
+    r0 = top + q[1] ; r1 = r0 + q[3] - 1 ;
+    if (r0 < Clip_r0) r0 = Clip_r0 ;
+    if (r1 > Clip_r1) r1 = Clip_r1 ;
+    for (row = r0 ; row <= r1 ; row++) Mm_Span (x0, x1, row) ;
+  }
+}
+
+
+
+static void Mm_Font_String (const char *s, int x, int top)
+// Mm_Glyph for each character of the string s, in the built in font
+// with the top left corner of the first cell at column x, row top
+{
+  int g ;
+
+  if (Font_Clip_Out (s, x, top)) return ;
+
+  for ( ; *s && (x <= Clip_c1) ; s++, x += FONT_WIDTH) {
+    if (x + FONT_WIDTH <= Clip_c0) continue ;
+    g = (unsigned char)*s - FONT_FIRST ;
+    if ((g < 0) || (g >= FONT_GLYPHS)) continue ;
+    Mm_Glyph (Font_Rect[g][0], Font_Nrect[g], x, top) ;
+  }
+}
+
+
+
+int Draw_String_M (const void *s, double Dx, double Dy)
+{
+  Mm_Font_String ((const char *)s, (int)Dx, Xx_Pix_height - (int)Dy - FONT_ASCENT) ;
+  return 1 ;
+}
+
+
+
+int Draw_Strings_M (int n, const void *strings, double *Dx, double *Dy)
+{
+  const char **s = (const char **)strings ;
+  int k ;
+
+  if (n < 0) return 0 ;
+  for (k = 0 ; k < n ; k++) {
+    Mm_Font_String (s[k], (int)Dx[k], Xx_Pix_height - (int)Dy[k] - FONT_ASCENT) ;
+  }
+  return 1 ;
+}
+
+
+
+int Antialias_M (int on)
+{
+  Mm_Antialias = (on != 0) ;
+  return 1 ;
+}
+
+
+
+int Change_Pen_Dimensions_M (double Dw, double Dh)
+// as Change_Pen_Dimensions_X : only Dw is used
+{
+  if ((Dw < 0) || (Dh < 0)) return 0 ;
+
+  Current_Pen_Width = Dw ;
+  return 1 ;
+}
+
+
+
+int Pen_Join_M (int style)
+{
+  if ((style != G_JOIN_MITER) && (style != G_JOIN_ROUND) && (style != G_JOIN_BEVEL)) return 0 ;
+
+  Current_Pen_Join = style ;
+  return 1 ;
+}
+
+
+
+int Set_Clip_Rect_M (double Dx, double Dy, double Dw, double Dh)
+// the writers of the buffer all keep to Clip_c0..Clip_r1
+{
+  return Clip_Set_Rect (Dx, Dy, Dw, Dh) ;
+}
+
+
+
+int Clear_Clip_M ()
+{
+  Clip_Whole_Window () ;
+  return 1 ;
+}
+
+
+
+static void Mm_Text_Glyph (const short *q, int nq, int x, int top, void *ctx)
+{
+  Mm_Glyph (q, nq, x, top) ;
+}
+
+
+
+int Draw_Text_M (
+               int num_lines_of_text,
+               const void *lines_of_text, // an array of pointers
+               double startx, 
+               double starty,
+               double height,
+               double x_over_y_ratio,
+               double extra_space_between_letters_fraction,
+               double extra_space_between_lines_fraction) 
+{
+  return Text_Lines (num_lines_of_text, lines_of_text, startx, starty,
+                     height, x_over_y_ratio,
+                     extra_space_between_letters_fraction,
+                     extra_space_between_lines_fraction, Mm_Text_Glyph, NULL) ;
+}
+
+
+
+int Save_Image_To_File_M (const void *filename)
+// return 1 if successful else 0
+{
+  FILE *fp ;
+
+  fp = fopen ((char *)filename,"w") ;
+  if (fp == NULL) {
+    printf("Save_Image_To_File_M cannot open file %s\n",(char *)filename) ;
+    return 0 ;
+  }
+
+  XImage_To_XWD_File (&Mm_Image,  fp) ;
+
+  fclose(fp) ;
+
+  return 1 ;
 }
 
 
 
-int XImage_to_Display (XImage *pxim, double Dx, double Dy)
-// Put lower left corner of file into the graphics window at (x,y).
+int Get_Image_From_File_M (const void *filename, double Dx, double Dy)
+// Put lower left corner of file into the buffer at (x,y),
+// clipped on all four sides (to the clip rectangle).
 // return 1 if successful else 0
 {
   int x = (int)Dx ;
   int y = (int)Dy ;
 
-  int image_width, image_height ;
-  int srcx,srcy,destx,desty ;
-  int transfer_width, transfer_height ;
+  FILE *fp ;
+  XImage xim[1] ;
+  int i, j, row0, col, row ;
+  unsigned int *src ;
+  int a = Current_Alpha_Weight ;
 
-  image_width = pxim->width ;
-  image_height = pxim->height ;
-  //  printf("%d %d\n",image_width,image_height) ;
+  fp = fopen ((char *)filename,"r") ;
+  if (fp == NULL) {
+    printf("Get_Image_From_File_M cannot open file %s\n",(char *)filename) ;
+    return 0 ;
+  }
 
-  if (image_height <= Xx_Pix_height - y) {
+  XImage_From_XWD_File (&xim[0], fp) ;
+  fclose(fp) ;
 
-    transfer_height = image_height ;
-    srcx = 0 ;
-    srcy = 0 ;
-    destx = x ;
-    desty = Xx_Pix_height - y - image_height ;
-    if (image_width <= Xx_Pix_width - x) { transfer_width = image_width ; }
-    else { transfer_width = Xx_Pix_width - x ;}
+  if (xim[0].bits_per_pixel != 32) {
+    printf("Get_Image_From_File_M needs 32 bit pixels\n") ;
+    free (xim[0].data) ;
+    return 0 ;
+  }
 
-  } else {
+  // device row of the top row of the image
+  row0 = Xx_Pix_height - y - xim[0].height ;
+
+  for (j = 0 ; j < xim[0].height ; j++) {
+    row = row0 + j ;
+    if ((row < Clip_r0) || (row > Clip_r1)) continue ;
+    src = (unsigned int *)(xim[0].data + j * xim[0].bytes_per_line) ;
+    for (i = 0 ; i < xim[0].width ; i++) {
+      col = x + i ;
+      if ((col < Clip_c0) || (col > Clip_c1)) continue ;
+      Mm_Put (&MM_PIXEL(col,row), src[i] & 0x00ffffff, a) ;
+    }
+  }
 
-    transfer_height = Xx_Pix_height - y ;
-    srcx = 0 ;
-    srcy = image_height - (Xx_Pix_height - y) ;
-    destx = x ;
-    desty = 0 ;
-    if (image_width <= Xx_Pix_width - x) { transfer_width = image_width ; }
-    else { transfer_width = Xx_Pix_width - x ;}
+  free (xim[0].data) ;
+  
+  return 1 ;
+}
 
-  }
 
 
-  XPutImage (XxDisplay, XxDrawable, XxPixmapContext, pxim,
-             srcx, srcy, destx, desty,
-             transfer_width, transfer_height) ;
-	     //	     Xx_Pix_width, Xx_Pix_height) ;
+int Get_Pixel_M (double Dx, double Dy)
+// return the 32 bit pixel value...assumes x,y are legal
+// i.e. it is NOT safe
+{
+  int x = (int)Dx ;
+  int y = (int)Dy ;
+
+  return MM_PIXEL(x, Xx_Pix_height - 1 - y) ;
+}
+
+
+
+int Get_Pixel_SAFE_M (double Dx, double Dy, int pixel[1]) 
+// return 1 if successful, else 0
+{
+  int x = (int)Dx ;
+  int y = (int)Dy ;
+
+  if ((x < 0) || (x >= Xx_Pix_width) || (y < 0) || (y >= Xx_Pix_height))
+    return 0 ;
+
+  pixel[0] = MM_PIXEL(x, Xx_Pix_height - 1 - y) ;
 
   return 1 ;
 }
 
 
 
-XImagePointer Get_ximage_of_display()
-// should be used with caution...
-// XImage pxim = Get_ximage_of_display() ;
-// later on, should do
-// XDestroyImage(pxim) 
-// when done with ximage or could create memory leak
+XImagePointer Get_Buffer_Image()
+// the whole back buffer as a 32 bit ZPixmap XImage, from
+// whichever backend is in use ... pair with Release_Buffer_Image
 {
-  XImage *pxim ;
+  if (Mm_Buffer != NULL) return &Mm_Image ;
 
-  pxim = XGetImage (XxDisplay, XxDrawable, 0,0, Xx_Pix_width, Xx_Pix_height,
+  return XGetImage (XxDisplay, XxDrawable, 0,0, Xx_Pix_width, Xx_Pix_height,
                       AllPlanes, ZPixmap) ;
+}
 
-  return pxim ;
+
+
+void Release_Buffer_Image (XImagePointer pxim)
+{
+  if (pxim != &Mm_Image) XDestroyImage(pxim) ;
 }
 
 
@@ -1871,9 +6143,44 @@ int (* G_events) (double *d) ;
 
 
 int (* G_change_pen_dimensions) (double w, double h) ;
+// the width of the pen for G_line, G_polyline, G_polygon,
+// G_triangle, G_rectangle and G_circle ; pens are round, so
+// h is only checked.  A width of 1 or less is the thin pen
+// (the default and the fastest).  Wide lines end square at
+// their end points.
 // return 0 if illegal w,h specified, otherwise 1
 
 
+int (* G_pen_join) (int style) ;
+// how the segments of wide lines meet at corners :
+// G_JOIN_MITER (pointed, the default ; very sharp corners are
+// beveled instead in the memory backend), G_JOIN_ROUND or
+// G_JOIN_BEVEL (cut straight across)
+// return 0 if style is not one of those, otherwise 1
+
+
+int (* G_set_clip_rect) (double x, double y, double w, double h) ;
+// limit all drawing, G_clear included, to the pixels that
+// G_fill_rectangle (x,y,w,h) would set, until G_clear_clip ;
+// primitives entirely outside it are skipped.  The depth
+// buffer of G_fill_triangle_3d is still cleared whole.
+// return 0 if none of the window is left (nothing will be
+// drawn), else 1
+
+int (* G_clear_clip) () ;
+// drawing may use the whole window again
+// return 1 always
+
+
+int (* G_antialias) (int on) ;
+// on != 0 : lines, circles and fills blend their edges into
+// the background by how much of each pixel they cover, and
+// take fractional coordinates as they are ; on = 0 : back to
+// plain pixels (the default).  Points, text, G_fill_triangle_rgb
+// and the _3d fills are never antialiased.
+// return 1 if the backend can antialias (memory), 0 if not (X)
+
+
 int (* Gi_get_current_window_dimensions) (int *dimentsions) ;
 // return 1 if successful
 // needs to be passed an array of two ints
@@ -1889,6 +6196,19 @@ int (* Gi_rgb) (int r, int g, int b) ;
 
 int (* G_rgb) (double r, double g, double b) ;
 // assumes r,g,b are doubles in [0, 1]
+// the color is opaque ; see G_rgba
+
+
+int (* Gi_rgba) (int r, int g, int b, int a) ;
+// assumes r,g,b,a are ints in [0, 255]
+
+
+int (* G_rgba) (double r, double g, double b, double a) ;
+// assumes r,g,b,a are doubles in [0, 1]
+// a is the opacity : from then on every point, line, fill,
+// G_clear and image drawn is mixed into what is already there,
+// color * a + old * (1 - a).  Gi_rgb and G_rgb set a = 1 again.
+// The X backend draws opaque colors only and ignores a.
 
 
 /////////////////////////////////////////////////////////////////////
@@ -1911,6 +6231,10 @@ int (* G_circle) (double a, double b, double r) ;
 // always return 1
 // capable of drawing a circle with thick outline
 
+int (* G_ellipse) (double a, double b, double rx, double ry) ;
+// the outline of G_fill_ellipse, with the pen width
+// return 0 if rx or ry is negative, otherwise 1
+
 int (* G_unclipped_line) (double ixs, double iys, double ixe, double iye) ;
 // return 1 always
 // This is SAFE.
@@ -1940,6 +6264,11 @@ int (* G_polygon) (double *x, double *y, double numpts) ;
 // return 1 always
 // capable of drawing a polygon with thick outline
 
+int (* G_polyline) (double *x, double *y, double numpts) ;
+// like G_polygon but not closed : the last point is not
+// joined back to the first
+// return 0 if numpts < 1, otherwise 1
+
 
 int (* G_triangle) (double x0, double y0, double x1, double y1, double x2, double y2) ; 
 // return value it inherits from G_polygon
@@ -1970,6 +6299,18 @@ int (* G_clear) () ;
 int (* G_fill_circle) (double a, double b, double r) ;
 // always return 1
 
+int (* G_fill_ellipse) (double a, double b, double rx, double ry) ;
+// the ellipse centered at (a,b) with half axes rx across and
+// ry up ; aliased in both backends
+// return 0 if rx or ry is negative, otherwise 1
+
+int (* G_fill_sector) (double xcenter, double ycenter, double radius,
+                       double start_radians, double end_radians) ;
+// the part of the filled circle counterclockwise from start to
+// end, with 0 <= end - start <= 2*M_PI ; neighbouring sectors
+// that share an angle fit without gaps
+// return 1 always
+
 
 int (* G_unclipped_fill_polygon) (double *xx, double *yy, double n) ;
 // return 0 if size needs to be truncated (unusual), else 1 
@@ -1991,10 +6332,60 @@ int (* G_fill_polygon) (double *xx, double *yy, double n) ;
 // AND it clips
 
 
+int (* G_polygon_xpoints) (XPoint *xpoints, int numpts) ;
+// outline of points already in device coordinates,
+// e.g. as produced by G_project_points
+// return 0 if numpts <= 0, else 1
+
+
+int (* G_fill_polygon_xpoints) (XPoint *xpoints, int numpts) ;
+// fill of points already in device coordinates,
+// e.g. as produced by G_project_points
+// return 0 if numpts <= 0, else 1
+// no 1000 point limit since nothing is copied
+
+
+int (* G_fill_prepared_polygon) (G_Prepared_Polygon *p, double dx, double dy) ;
+// fill a polygon made by G_prepare_polygon, moved by (dx,dy)
+// rounded to whole pixels.  Where the moved vertices are all at
+// x >= 0 and at or below the top row of the window, the pixels
+// are those G_fill_polygon gives for them ; past those edges
+// G_fill_polygon truncates toward 0 while the prepared polygon
+// was rounded down, and they can differ (antialiased, the
+// offset is exact and they agree everywhere)
+// return 0 if p is NULL, else 1
+
+
 int (* G_fill_triangle) (double x0, double y0, double x1, double y1, double x2, double y2) ; 
 // return value it inherits from G_fill_polygon
 
 
+int (* G_fill_triangle_rgb) (double x[3], double y[3], double rgb[3][3]) ;
+// rgb[i] in [0,1] is the color at (x[i],y[i]) ; the colors are
+// blended smoothly across the triangle where the backend can
+// (memory), otherwise their average is used (X)
+// return 1 always
+
+
+int (* G_fill_triangle_3d) (double x0, double y0, double z0,
+                            double x1, double y1, double z1,
+                            double x2, double y2, double z2) ;
+// (x[i],y[i]) are window coordinates and z[i] a depth, smaller
+// being nearer.  Each pixel is drawn only if it is nearer than
+// what is already there ; G_clear clears the depths as well.
+// Depth is interpolated linearly across the window, which is
+// exact for parallel projections ; with perspective pass -1/Z
+// (Z as in G_project_points) to keep it exact.
+// X runs the same depth test on the client and sends the pixels
+// that pass, so both backends draw the same pixels.
+// return 0 if the depth buffer can't be allocated, else 1
+
+
+int (* G_fill_polygon_3d) (double *x, double *y, double *z, double n) ;
+// the same for a convex polygon of n vertices
+// return 0 if n < 3 or the depth buffer can't be allocated, else 1
+
+
 int (* G_fill_rectangle) (double xleft, double yleft, double width, double height) ;
 // return value it inherits from G_fill_polygon
 
@@ -2015,12 +6406,22 @@ int (* G_font_pixel_height) () ;
 int (* G_string_pixel_width) (const void *s) ;
 // return the length in pixles of the string s
 
+int (* G_string_pixel_widths) (int n, const void *strings, int *widths) ;
+// widths[k] = G_string_pixel_width (strings[k]) for k < n, where
+// strings is an array of pointers ; return 0 if n < 0, else 1
+
 int (* G_draw_string) (const void *one_line_of_text, double LLx, double LLy) ;
 // draw a single line of text beginning at (LLx,LLy) which specifies
 // the coordinates of the lower left corner of the bounding box
 // of the text
 
 
+int (* G_draw_strings) (int n, const void *strings, double *x, double *y) ;
+// G_draw_string of strings[k] at (x[k],y[k]) for k < n, where
+// strings is an array of pointers ; return 0 if n < 0, else 1.
+// Drawn in the built in font, all the strings go out together
+
+
 int (* G_draw_text) (
                int num_lines_of_text,
                const void  *lines_of_text, // an array of pointers
@@ -2030,6 +6431,12 @@ int (* G_draw_text) (
                double x_over_y_ratio,
                double extra_space_between_letters_fraction,
                double extra_space_between_lines_fraction) ;
+// the lines in the built in font, its cells scaled to height pixels
+// by x_over_y_ratio * height ; the first line has its lower left
+// corner at (startx,starty), the others follow below it.  The
+// fractions are of a cell, added between letters and between lines.
+// Each size keeps its glyphs, for the last TEXT_CACHE_SIZES sizes.
+// return 0 if the cell is not positive (or too large), else 1
 
 
 int (* G_save_image_to_file) (const void *filename) ;
@@ -2085,6 +6492,14 @@ int  G_init_graphics (double w, double h)
 
  G_change_pen_dimensions =  Change_Pen_Dimensions_X ;
 
+ G_pen_join = Pen_Join_X ;
+
+ G_set_clip_rect = Set_Clip_Rect_X ;
+
+ G_clear_clip = Clear_Clip_X ;
+
+ G_antialias = Antialias_X ;
+
  Gi_get_current_window_dimensions = Get_Current_Dimensions_X ;
 
  G_get_current_window_dimensions = Get_Current_Dimensions_DX ;
@@ -2093,12 +6508,18 @@ int  G_init_graphics (double w, double h)
 
  G_rgb = Set_Color_Rgb_DX ;
 
+ Gi_rgba = Set_Color_Rgba_X ;
+
+ G_rgba = Set_Color_Rgba_DX ;
+
  G_pixel = Point_X ;
 
  G_point = Safe_Point_X ;
 
  G_circle = Circle_X ;
 
+ G_ellipse = Ellipse_X ;
+
  G_unclipped_line = Line_X ;
 
  // G_line = Line_X ;
@@ -2108,6 +6529,8 @@ int  G_init_graphics (double w, double h)
 
  G_polygon = Polygon_DX ;
 
+ G_polyline = Polyline_DX ;
+
  G_triangle = Triangle_X ; 
 
  G_rectangle = Rectangle_X ; 
@@ -2118,21 +6541,39 @@ int  G_init_graphics (double w, double h)
 
  G_fill_circle =  Fill_Circle_X ;
 
+ G_fill_sector = Fill_Sector_X ;
+
+ G_fill_ellipse = Fill_Ellipse_X ;
+
+ G_fill_prepared_polygon = Fill_Prepared_Polygon_X ;
+
  G_unclipped_fill_polygon =  Fill_Polygon_DX ; 
 
  Gi_fill_polygon = Fill_Polygon_X ; 
 
  G_fill_polygon = Fill_Polygon_DX ; 
 
+ G_polygon_xpoints = Polygon_XPoints_X ;
+
+ G_fill_polygon_xpoints = Fill_Polygon_XPoints_X ;
+
  G_fill_triangle = Fill_Triangle_X ;
 
+ G_fill_triangle_rgb = Fill_Triangle_Rgb_X ;
+
+ G_fill_triangle_3d = Fill_Triangle_3d_X ;
+
+ G_fill_polygon_3d = Fill_Polygon_3d_X ;
+
  G_fill_rectangle = Fill_Rectangle_X ;
 
  G_font_pixel_height = Font_Pixel_Height_X ;
 
  G_string_pixel_width = String_Pixel_Width_X ;
+ G_string_pixel_widths = String_Pixel_Widths_X ;
 
  G_draw_string = Draw_String_X ;
+ G_draw_strings = Draw_Strings_X ;
 
  G_draw_text = Draw_Text_X ;
 
@@ -2154,6 +6595,129 @@ int  G_init_graphics (double w, double h)
 }
 
 
+
+int  G_init_graphics_memory (double w, double h)
+// Same as G_init_graphics, but everything is drawn into a
+// w x h frame buffer in main memory instead of an X window.
+// Nothing is ever displayed : use G_save_image_to_file or
+// G_save_to_bmp_file to see the result.  There is no input,
+// so G_wait_key and G_wait_click return at once.
+// return 0 if the buffer could not be allocated, else 1
+{
+ int s ;
+
+ G_close = Close_Down_M ;
+
+ G_display_image = Copy_Buffer_And_Flush_M ;
+
+ Gi_events = Get_Events_M ;
+
+ G_events = Get_Events_DM ;
+
+ G_change_pen_dimensions =  Change_Pen_Dimensions_M ;
+
+ G_pen_join = Pen_Join_M ;
+
+ G_set_clip_rect = Set_Clip_Rect_M ;
+
+ G_clear_clip = Clear_Clip_M ;
+
+ G_antialias = Antialias_M ;
+
+ Gi_get_current_window_dimensions = Get_Current_Dimensions_X ;
+
+ G_get_current_window_dimensions = Get_Current_Dimensions_DX ;
+
+ Gi_rgb = Set_Color_Rgb_M ;
+
+ G_rgb = Set_Color_Rgb_DM ;
+
+ Gi_rgba = Set_Color_Rgba_M ;
+
+ G_rgba = Set_Color_Rgba_DM ;
+
+ G_pixel = Point_M ;
+
+ G_point = Safe_Point_M ;
+
+ G_circle = Circle_M ;
+
+ G_ellipse = Ellipse_M ;
+
+ G_unclipped_line = Line_M ;
+
+ G_line = Safe_Line_M ;
+
+ Gi_polygon = Polygon_M ; 
+
+ G_polygon = Polygon_DM ;
+
+ G_polyline = Polyline_DM ;
+
+ G_triangle = Triangle_M ; 
+
+ G_rectangle = Rectangle_M ; 
+
+ G_single_pixel_horizontal_line = Horizontal_Single_Pixel_Line_M ;
+
+ G_clear = Clear_Buffer_M ;
+
+ G_fill_circle =  Fill_Circle_M ;
+
+ G_fill_sector = Fill_Sector_M ;
+
+ G_fill_ellipse = Fill_Ellipse_M ;
+
+ G_fill_prepared_polygon = Fill_Prepared_Polygon_M ;
+
+ G_unclipped_fill_polygon =  Fill_Polygon_DM ; 
+
+ Gi_fill_polygon = Fill_Polygon_M ; 
+
+ G_fill_polygon = Fill_Polygon_DM ; 
+
+ G_polygon_xpoints = Polygon_XPoints_M ;
+
+ G_fill_polygon_xpoints = Fill_Polygon_XPoints_M ;
+
+ G_fill_triangle = Fill_Triangle_M ;
+
+ G_fill_triangle_rgb = Fill_Triangle_Rgb_M ;
+
+ G_fill_triangle_3d = Fill_Triangle_3d_M ;
+
+ G_fill_polygon_3d = Fill_Polygon_3d_M ;
+
+ G_fill_rectangle = Fill_Rectangle_M ;
+
+ G_font_pixel_height = Font_Pixel_Height_M ;
+
+ G_string_pixel_width = String_Pixel_Width_M ;
+ G_string_pixel_widths = String_Pixel_Widths_M ;
+
+ G_draw_string = Draw_String_M ;
+ G_draw_strings = Draw_Strings_M ;
+
+ G_draw_text = Draw_Text_M ;
+
+ G_save_image_to_file = Save_Image_To_File_M ;
+
+ G_get_image_from_file = Get_Image_From_File_M ;
+
+ G_get_pixel = Get_Pixel_M ;
+
+ G_get_pixel_SAFE = Get_Pixel_SAFE_M ;
+
+ G_convert_pixel_to_rgbI = Convert_Pixel_To_rgbI_X ;
+
+ G_convert_rgbI_to_rgb = Convert_rgbI_To_rgb_X ;
+
+ s = Init_M(w,h) ;
+
+ return s ;
+}
+
+
 ///////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////
 
@@ -2168,6 +6732,11 @@ int Gi_wait_click(int p[2])
   int sig ;
 
   G_display_image();  
+  if (Mm_Buffer != NULL) {
+    // headless : nobody can click
+    p[0] = 0 ; p[1] = 0 ;
+    return -3 ;
+  }
   do {
     sig = Gi_events(p) ;
   }  while (sig != -3) ;
@@ -2197,6 +6766,7 @@ int G_wait_key()
   int sig ;
 
   G_display_image();  
+  if (Mm_Buffer != NULL) return 'q' ; // headless : act as if the user quit
   do {
     sig = Gi_events(p) ;
   }  while (sig < 0) ;
@@ -2227,65 +6797,84 @@ int G_no_wait_key()
 
 
 /////////////////////////////////////////////////////////////////
+// fused 3d -> screen pipeline
 /////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////
-// Added Aug 28, 2012
-
 
-
-static int sector(double xcenter, double ycenter, double radius, 
-                  double start_radians, double end_radians,
-                  double *x, double *y,
-	          int num_pts_in_full_circle) 
+#define G_XPOINT_GUARD 16000
+// projected coordinates are clamped to +- this so that they
+// always fit in the shorts of an XPoint ; the rasterizer
+// clips to the window itself
+
+
+int G_project_points (double x[], double y[], double z[], 
+                      double m[4][4],
+                      double viewport[4], double hither,
+                      XPoint xpoints[], int n)
+// One pass over the points doing all of
+//     (X,Y,Z) = m * (x,y,z)
+//     xbar = viewport[0] * X/Z + viewport[2]
+//     ybar = viewport[1] * Y/Z + viewport[3]
+// and writing (xbar, ybar) to xpoints[] already y-flipped,
+// ready for G_fill_polygon_xpoints or G_polygon_xpoints.
+// Typically viewport = { H/tan(half_angle), H/tan(half_angle), W/2, H/2 }.
+// No intermediate arrays of doubles are made.
+// Return 1 if every point has Z >= hither, else 0 ...
+// in that case the offending points are still clamped but the
+// caller should clip or skip the polygon.
 {
-  int num,j ;
-  double theta,delta ;
-
-  //  printf("start = %lf  end = %lf\n",start_radians,end_radians) ;
-
-  delta = end_radians - start_radians ;
-  if (delta < 0) return 0 ;
-  if (delta > 2*M_PI) return 0 ;
-
-  num = (int)(num_pts_in_full_circle*delta/(2*M_PI)) ;
-
-  //  printf("delta = %lf  num = %d\n",delta,num) ;
-
-  if (num < 1) { num = 1 ; }
-  else if (num > 500) { num = 500 ; }
-
-  //  printf("new num = %d\n",num) ;
+  double m00 = m[0][0], m01 = m[0][1], m02 = m[0][2], m03 = m[0][3] ;
+  double m10 = m[1][0], m11 = m[1][1], m12 = m[1][2], m13 = m[1][3] ;
+  double m20 = m[2][0], m21 = m[2][1], m22 = m[2][2], m23 = m[2][3] ;
+  double sx = viewport[0] ;
+  double sy = viewport[1] ;
+  double cx = viewport[2] ;
+  double cy = (Xx_Pix_height - 1) - viewport[3] ; // y flip folded in
+  double u,v,t,w,xbar,ybar ;
+  int i, all_in_front ;
+
+  all_in_front = 1 ;
+  for (i = 0 ; i < n ; i++) {
+    u = m00*x[i] + m01*y[i] + m02*z[i] + m03 ;
+    v = m10*x[i] + m11*y[i] + m12*z[i] + m13 ;
+    t = m20*x[i] + m21*y[i] + m22*z[i] + m23 ;
+
+    if (t < hither) { all_in_front = 0 ; t = hither ; }
+    if (t == 0) t = 1e-12 ;
+    w = 1.0/t ;
+
+    xbar = cx + sx*u*w ;
+    ybar = cy - sy*v*w ;
+
+    if (xbar < -G_XPOINT_GUARD) xbar = -G_XPOINT_GUARD ;
+    else if (xbar > G_XPOINT_GUARD) xbar = G_XPOINT_GUARD ;
+    if (ybar < -G_XPOINT_GUARD) ybar = -G_XPOINT_GUARD ;
+    else if (ybar > G_XPOINT_GUARD) ybar = G_XPOINT_GUARD ;
+
+    xpoints[i].x = (int)xbar ;
+    xpoints[i].y = (int)ybar ;
+  }
 
-  j = 0 ; 
-  while (j <= num) {
-    theta = start_radians + j*delta/num;
+  return all_in_front ;
+}
 
-    // printf("j = %d  theta = %lf\n",j,theta) ;
 
-    x[j] = xcenter + radius*cos(theta) ;
-    y[j] = ycenter + radius*sin(theta) ;
 
-    j++ ;
-  }
-  x[j] = xcenter ;y[j] = ycenter ; j++ ;
 
-  return j ;
-}
+/////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////
+// Added Aug 28, 2012
 
 
 
 int G_sector(double xcenter, double ycenter, double radius, 
              double start_radians, double end_radians)
 {
-  int num_pts_in_full_circle, n ;
-  double x[500+3],y[500+3] ;
-
-  num_pts_in_full_circle = 500 ;
+  int n ;
+  double x[SECTOR_MAX_STEPS+2],y[SECTOR_MAX_STEPS+2] ;
 
   n = sector(xcenter,ycenter,radius,start_radians,end_radians,
-             x,y,num_pts_in_full_circle) ;
-
-  // normally, n == num_pts_in_full_circle + 1 
+             x,y) ;
 
   if (n <= 0) {
     printf("Sector flaw\n") ;
@@ -2299,30 +6888,158 @@ int G_sector(double xcenter, double ycenter, double radius,
 
 
 
-int G_fill_sector(double xcenter, double ycenter, double radius, 
-                  double start_radians, double end_radians)
+/////////////////////////////////////////////////////////////////
+// Prepared polygons
+
+static int *Prep_Span ;   // 3 ints each : x0, x1, row
+static int Prep_Nspan, Prep_Size, Prep_Failed ;
+
+
+static void Prep_Add_Span (int x0, int x1, int row)
+{
+  int *t ;
+
+  if (Prep_Failed) return ;
+  if (Prep_Nspan == Prep_Size) {
+    Prep_Size = (Prep_Size < 256) ? 256 : 2 * Prep_Size ;
+    t = (int *) realloc(Prep_Span, 3 * Prep_Size * sizeof(int)) ;
+    if (t == NULL) { Prep_Failed = 1 ; return ; }
+    Prep_Span = t ;
+  }
+  t = Prep_Span + 3 * Prep_Nspan++ ;
+  t[0] = x0 ; t[1] = x1 ; t[2] = row ;
+}
+
+
+
+int G_free_prepared_polygon (G_Prepared_Polygon *p)
+// return 1 always
 {
-  int num_pts_in_full_circle, n ;
-  double x[500+3],y[500+3] ;
+  if (p == NULL) return 1 ;
+  free(p->x) ;
+  free(p->rect) ;
+  free(p->xp) ;
+  free(p) ;
+  return 1 ;
+}
 
-  num_pts_in_full_circle = 500 ;
 
-  n = sector(xcenter,ycenter,radius,start_radians,end_radians,
-             x,y,num_pts_in_full_circle) ;
 
-  // normally, n == num_pts_in_full_circle + 1 
+G_Prepared_Polygon *G_prepare_polygon (double *x, double *y, double Dnpts)
+// Scan the polygon (x[i],y[i]), i < n, once, with the top row of
+// the window as row 0, and keep its pixels as rectangles : a span
+// that repeats the one right above it lengthens that rectangle
+// instead of starting another.  The vertices are rounded down,
+// so that the pixels move with the whole pixel offsets of
+// G_fill_prepared_polygon ; G_fill_polygon truncates toward 0
+// instead, which differs left of x = 0 and above the top row.
+// There is no limit on n.
+// return NULL if n < 1 or out of memory, free with G_free_prepared_polygon
+{
+  int npts = (int)Dnpts ;
+  G_Prepared_Polygon *p ;
+  int *ix, *top, *id, *q, *s ;
+  int k, i, j, a, b, c, d, row ;
+
+  if (npts <= 0) return NULL ;
+
+  p = (G_Prepared_Polygon *) malloc(sizeof(G_Prepared_Polygon)) ;
+  ix = (int *) malloc(2 * npts * sizeof(int)) ;
+  if (p != NULL) p->x = (double *) malloc(2 * npts * sizeof(double)) ;
+  if ((p == NULL) || (ix == NULL) || (p->x == NULL)) {
+    if (p != NULL) free(p->x) ;
+    free(p) ; free(ix) ;
+    return NULL ;
+  }
+  p->n = npts ;
+  p->y = p->x + npts ;
+  p->rect = NULL ;
+  p->nrect = 0 ;
+  p->xp = (XPoint *) malloc(npts * sizeof(XPoint)) ;
+
+  // rows less Xx_Pix_height - 1, rounded down like the columns
+  top = ix + npts ;
+  for (k = 0 ; k < npts ; k++) {
+    p->x[k] = x[k] ;
+    p->y[k] = y[k] ;
+    ix[k] = (int)floor(x[k]) ;
+    top[k] = (int)floor(-y[k]) ;
+  }
 
-  if (n <= 0) {
-    printf("Sector flaw\n") ;
-  } else {
-    G_fill_polygon(x,y,n) ;
+  // the points for X, unless a step between two of them overflows
+  // a short ; without them X sends the rectangles
+  p->vx0 = p->vx1 = ix[0] ;
+  p->vtop0 = p->vtop1 = top[0] ;
+  for (k = 0 ; k < npts ; k++) {
+    if (ix[k] < p->vx0) p->vx0 = ix[k] ;
+    if (ix[k] > p->vx1) p->vx1 = ix[k] ;
+    if (top[k] < p->vtop0) p->vtop0 = top[k] ;
+    if (top[k] > p->vtop1) p->vtop1 = top[k] ;
+  }
+  if ((p->vx1 - p->vx0 > SHRT_MAX) || (p->vtop1 - p->vtop0 > SHRT_MAX)) {
+    free(p->xp) ;
+    p->xp = NULL ;
+  }
+  if (p->xp != NULL) {
+    p->xp[0].x = 0 ; // the first point is set by each fill
+    p->xp[0].y = 0 ;
+    for (k = 1 ; k < npts ; k++) {
+      p->xp[k].x = ix[k] - ix[k-1] ;
+      p->xp[k].y = top[k] - top[k-1] ;
+    }
   }
 
-  return 1 ;
+  Prep_Nspan = 0 ;
+  Prep_Failed = 0 ;
+  if (!Scan_Device_Polygon (ix, top, npts, 0, Prep_Add_Span) || Prep_Failed) {
+    free(ix) ; G_free_prepared_polygon (p) ;
+    return NULL ;
+  }
+  free(ix) ;
+
+  // id[j] is the rectangle of span j
+  id = (int *) malloc((Prep_Nspan + 1) * sizeof(int)) ;
+  p->rect = (int *) malloc((4 * Prep_Nspan + 1) * sizeof(int)) ;
+  if ((id == NULL) || (p->rect == NULL)) {
+    free(id) ; G_free_prepared_polygon (p) ;
+    return NULL ;
+  }
+
+  p->x0 = p->top0 = INT_MAX ;
+  p->x1 = p->top1 = INT_MIN ;
+  a = b = 0 ; // spans of the row above
+  for (c = 0 ; c < Prep_Nspan ; c = d) {
+    row = Prep_Span[3*c+2] ;
+    for (d = c ; (d < Prep_Nspan) && (Prep_Span[3*d+2] == row) ; d++) ;
+    if ((a < b) && (Prep_Span[3*a+2] != row - 1)) a = b ;
+
+    for (j = c, i = a ; j < d ; j++) {
+      s = Prep_Span + 3*j ;
+      while ((i < b) && (Prep_Span[3*i] < s[0])) i++ ;
+      if ((i < b) && (Prep_Span[3*i] == s[0]) && (Prep_Span[3*i+1] == s[1])) {
+        id[j] = id[i] ;
+        p->rect[4*id[j]+3]++ ;
+        continue ;
+      }
+      id[j] = p->nrect ;
+      q = p->rect + 4 * p->nrect++ ;
+      q[0] = s[0] ; q[1] = row ; q[2] = s[1] - s[0] + 1 ; q[3] = 1 ;
+      if (s[0] < p->x0) p->x0 = s[0] ;
+      if (s[1] > p->x1) p->x1 = s[1] ;
+    }
+    if (row < p->top0) p->top0 = row ;
+    p->top1 = row ;
+    a = c ; b = d ;
+  }
+  free(id) ;
+  if (p->nrect == 0) { p->x0 = p->top0 = 0 ; p->x1 = p->top1 = -1 ; }
+
+  return p ;
 }
 
 
 
+
 /////////////////////////////////////////////////////////////////
 
 static double mouse_values[2] ;
@@ -2523,10 +7240,9 @@ int G_save_to_bmp_file (char *fname)
 {
 
   //==================================  
-  // X11 stuff
+  // X11 stuff (or the memory backend's buffer)
   XImage *pxim ;
-  pxim = XGetImage (XxDisplay, XxDrawable, 0,0, Xx_Pix_width, Xx_Pix_height,
-                      AllPlanes, ZPixmap) ;
+  pxim = Get_Buffer_Image() ;
   //==================================
 
 
@@ -2600,7 +7316,7 @@ int G_save_to_bmp_file (char *fname)
 
   //==================================  
   // X11 stuff
-  XDestroyImage(pxim) ; // lack of this was causing mem leaks when
+  Release_Buffer_Image(pxim) ; // lack of this was causing mem leaks when
   // many images were being saved for movies
   //==================================  
   
@@ -2711,9 +7427,10 @@ int G_display_bmp_file (char filename[], int xoffset, int yoffset)
 
 
   
-  // input the color data
+  // input the color data, drawn with the alpha in effect now
   int y,count,x ;
   unsigned char r,g,b ;
+  int a = Current_Alpha_Int ;
 
   for (y = 0 ; y < height_of_bitmap_in_pixels ; y++) {
     count = 0 ; 
@@ -2734,7 +7451,7 @@ int G_display_bmp_file (char filename[], int xoffset, int yoffset)
       count++ ;
 
 
-      Gi_rgb(r,g,b) ;
+      Gi_rgba(r,g,b,a) ;
       G_point(x+xoffset,y+yoffset) ;
       
     }
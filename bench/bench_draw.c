@@ -0,0 +1,327 @@
+/**
+ * @file bench_draw.c
+ * @brief Primitive throughput of the G_* drawing API in FPToolkit.c.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * Build and run from the top of the tree, on a desktop or a virtual X server:
+ *
+ *     gcc -O2 bench/bench_draw.c -lm -lX11 -o bench_draw
+ *     Xvfb :99 -screen 0 1280x1024x24 &
+ *     DISPLAY=:99 ./bench_draw > bench_output.txt
+ *
+ * or with no X server at all, against the in-memory backend:
+ *
+ *     ./bench_draw --memory > bench_output.txt
+ *
+ * Each case draws a batch of primitives from precomputed random positions, then
+ * waits for the X server to finish (XSync) before the clock is stopped, so the
+ * numbers include the server's rasterization and not only the request queueing.
+ * A case gets one warm-up batch and then --repeats timed batches; ops_per_sec is
+ * the best batch and ops_per_sec_median the median.  The results are printed as
+ * one JSON object on stdout.
+ *
+ * Options:
+ *     --memory        use G_init_graphics_memory instead of an X window
+ *     --size N        window width and height (default 800)
+ *     --repeats N     timed batches per case (default 5)
+ *     --scale F       multiply every batch length by F (default 1)
+ *     --tmpdir DIR    where the save/load cases write their files (default /tmp)
+ *     --filter TEXT   only run the cases whose name contains TEXT
+ */
+
+#include "../FPToolkit.c"
+
+
+/* Random inputs, cycled through by every case */
+
+#define NRAND 4096  // a power of 2
+static double rx[NRAND], ry[NRAND];
+static double line_scale;  // shrinks any in-window segment to at most 100 pixels
+static double poly_x[1024], poly_y[1024];
+static int poly_n;
+static double radius;
+static int width_px, height_px;
+static char tmp_xwd[300], tmp_bmp[300];
+
+static const char text_line[] = "The quick brown fox jumps over the lazy dog";
+
+
+/* Cases; each draws n primitives */
+
+static void c_point(int n){
+    int i;
+    for (i = 0; i < n; i++) G_point(rx[i & (NRAND - 1)], ry[i & (NRAND - 1)]);
+}
+
+static void c_pixel(int n){
+    int i;
+    for (i = 0; i < n; i++) G_pixel(rx[i & (NRAND - 1)], ry[i & (NRAND - 1)]);
+}
+
+// lines of up to 100 pixels, all inside the window
+static void c_line_short(int n){
+    int i, j, k;
+    for (i = 0; i < n; i++){
+        j = i & (NRAND - 1);
+        k = (i + 1) & (NRAND - 1);
+        G_line(rx[j], ry[j], rx[j] + (rx[k] - rx[j]) * line_scale, ry[j] + (ry[k] - ry[j]) * line_scale);
+    }
+}
+
+// lines that cross the whole window and need clipping
+static void c_line_clipped(int n){
+    int i, j;
+    for (i = 0; i < n; i++){
+        j = i & (NRAND - 1);
+        G_line(-width_px, ry[j] * 3 - height_px, 2 * width_px, height_px * 2 - ry[j] * 3);
+    }
+}
+
+static void c_fill_triangle(int n){
+    int i, j;
+    for (i = 0; i < n; i++){
+        j = i & (NRAND - 1);
+        G_fill_triangle(rx[j], ry[j], rx[j] + 40, ry[j] + 10, rx[j] + 15, ry[j] + 45);
+    }
+}
+
+static void c_fill_rectangle(int n){
+    int i, j;
+    for (i = 0; i < n; i++){
+        j = i & (NRAND - 1);
+        G_fill_rectangle(rx[j], ry[j], 32, 32);
+    }
+}
+
+static void c_fill_polygon(int n){
+    int i;
+    for (i = 0; i < n; i++) G_fill_polygon(poly_x, poly_y, poly_n);
+}
+
+static void c_fill_circle(int n){
+    int i, j;
+    for (i = 0; i < n; i++){
+        j = i & (NRAND - 1);
+        G_fill_circle(rx[j], ry[j], radius);
+    }
+}
+
+static void c_circle(int n){
+    int i, j;
+    for (i = 0; i < n; i++){
+        j = i & (NRAND - 1);
+        G_circle(rx[j], ry[j], radius);
+    }
+}
+
+static void c_draw_string(int n){
+    int i, j;
+    for (i = 0; i < n; i++){
+        j = i & (NRAND - 1);
+        G_draw_string(text_line, rx[j] * 0.5, ry[j]);
+    }
+}
+
+static void c_string_pixel_width(int n){
+    int i;
+    for (i = 0; i < n; i++) G_string_pixel_width(text_line);
+}
+
+static void c_clear(int n){
+    int i;
+    for (i = 0; i < n; i++) G_clear();
+}
+
+static void c_display_image(int n){
+    int i;
+    for (i = 0; i < n; i++) G_display_image();
+}
+
+static void c_save_xwd(int n){
+    int i;
+    for (i = 0; i < n; i++) G_save_image_to_file(tmp_xwd);
+}
+
+static void c_load_xwd(int n){
+    int i;
+    for (i = 0; i < n; i++) G_get_image_from_file(tmp_xwd, 0, 0);
+}
+
+static void c_save_bmp(int n){
+    int i;
+    for (i = 0; i < n; i++) G_save_to_bmp_file(tmp_bmp);
+}
+
+static void c_load_bmp(int n){
+    int i;
+    for (i = 0; i < n; i++) G_display_bmp_file(tmp_bmp, 0, 0);
+}
+
+
+/* Registry */
+
+typedef struct Case {
+    const char *name;
+    void (*run)(int n);
+    int batch;      // primitives per timed batch before --scale
+    int param;      // vertex count or radius, 0 if unused
+    const char *unit;
+} Case;
+
+static Case cases[] = {
+    {"point",              c_point,              100000, 0,   "points"},
+    {"pixel",              c_pixel,              100000, 0,   "points"},
+    {"line_short",         c_line_short,         50000,  0,   "lines"},
+    {"line_clipped",       c_line_clipped,       20000,  0,   "lines"},
+    {"fill_triangle",      c_fill_triangle,      50000,  0,   "triangles"},
+    {"fill_rectangle",     c_fill_rectangle,     50000,  0,   "rectangles"},
+    {"fill_polygon",       c_fill_polygon,       20000,  3,   "polygons"},
+    {"fill_polygon",       c_fill_polygon,       20000,  8,   "polygons"},
+    {"fill_polygon",       c_fill_polygon,       10000,  32,  "polygons"},
+    {"fill_polygon",       c_fill_polygon,       5000,   128, "polygons"},
+    {"fill_polygon",       c_fill_polygon,       1000,   999, "polygons"},
+    {"circle",             c_circle,             20000,  32,  "circles"},
+    {"fill_circle",        c_fill_circle,        50000,  2,   "circles"},
+    {"fill_circle",        c_fill_circle,        20000,  8,   "circles"},
+    {"fill_circle",        c_fill_circle,        10000,  32,  "circles"},
+    {"fill_circle",        c_fill_circle,        2000,   128, "circles"},
+    {"fill_circle",        c_fill_circle,        200,    512, "circles"},
+    {"draw_string",        c_draw_string,        20000,  0,   "strings"},
+    {"string_pixel_width", c_string_pixel_width, 100000, 0,   "strings"},
+    {"clear",              c_clear,              500,    0,   "clears"},
+    {"display_image",      c_display_image,      500,    0,   "presents"},
+    {"save_xwd",           c_save_xwd,           20,     0,   "files"},
+    {"load_xwd",           c_load_xwd,           20,     0,   "files"},
+    {"save_bmp",           c_save_bmp,           20,     0,   "files"},
+    {"load_bmp",           c_load_bmp,           20,     0,   "files"},
+};
+
+
+/* Setup */
+
+// a regular polygon of n vertices around the window center
+static void make_polygon(int n){
+    int i;
+    double r = 0.3 * width_px;
+    if (n > 1024) n = 1024;
+    for (i = 0; i < n; i++){
+        poly_x[i] = 0.5 * width_px + r * cos(2 * M_PI * i / n);
+        poly_y[i] = 0.5 * height_px + r * sin(2 * M_PI * i / n);
+    }
+    poly_n = n;
+}
+
+static void setup(void){
+    int i;
+    srand48(1);
+    for (i = 0; i < NRAND; i++){
+        rx[i] = drand48() * width_px;
+        ry[i] = drand48() * height_px;
+    }
+    line_scale = 100 / sqrt((double)width_px * width_px + (double)height_px * height_px);
+
+    // something non-trivial for the save/load cases to carry
+    G_rgb(0.2, 0.4, 0.6);
+    G_clear();
+    G_rgb(1, 0.5, 0);
+    G_fill_circle(0.5 * width_px, 0.5 * height_px, 0.25 * width_px);
+    G_save_image_to_file(tmp_xwd);
+    G_save_to_bmp_file(tmp_bmp);
+}
+
+
+/* Timing */
+
+static double now_seconds(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// waits until every request sent so far has been carried out
+static void finish(void){
+    if (Mm_Buffer == NULL) XSync(XxDisplay, False);
+}
+
+static int compare_doubles(const void *a, const void *b){
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void run_case(const Case *c, int n, int repeats, int first){
+    double samples[64];
+    double start;
+    int k;
+
+    if (c->run == c_fill_polygon) make_polygon(c->param);
+    if (c->run == c_fill_circle || c->run == c_circle) radius = c->param;
+
+    G_rgb(drand48(), drand48(), drand48());
+    c->run(n);
+    finish();
+
+    for (k = 0; k < repeats; k++){
+        start = now_seconds();
+        c->run(n);
+        finish();
+        samples[k] = n / (now_seconds() - start);
+    }
+    qsort(samples, repeats, sizeof(double), compare_doubles);
+
+    printf("%s\n    {\"name\": \"%s\", \"param\": %d, \"unit\": \"%s\", \"batch\": %d, \"repeats\": %d, "
+           "\"ops_per_sec\": %.6g, \"ops_per_sec_median\": %.6g, \"ns_per_op\": %.2f}",
+           first ? "" : ",", c->name, c->param, c->unit, n, repeats,
+           samples[repeats - 1], samples[(repeats - 1) / 2], 1e9 / samples[repeats - 1]);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv){
+    int size = 800, repeats = 5;
+    double scale = 1;
+    const char *filter = NULL, *tmpdir = "/tmp";
+    int i, n, first = 1, memory = 0;
+
+    for (i = 1; i < argc; i++){
+        if (strcmp(argv[i], "--memory") == 0) memory = 1;
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) size = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--repeats") == 0 && i + 1 < argc) repeats = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) scale = atof(argv[++i]);
+        else if (strcmp(argv[i], "--tmpdir") == 0 && i + 1 < argc) tmpdir = argv[++i];
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [--memory] [--size N] [--repeats N] [--scale F] [--tmpdir DIR] [--filter TEXT]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (size < 64) size = 64;
+    if (repeats < 1) repeats = 1;
+    if (repeats > 64) repeats = 64;
+    snprintf(tmp_xwd, sizeof(tmp_xwd), "%s/bench_draw_%d.xwd", tmpdir, (int)getpid());
+    snprintf(tmp_bmp, sizeof(tmp_bmp), "%s/bench_draw_%d.bmp", tmpdir, (int)getpid());
+
+    if (!(memory ? G_init_graphics_memory(size, size) : G_init_graphics(size, size))){
+        fprintf(stderr, "bench_draw: could not set up the graphics\n");
+        return 1;
+    }
+    width_px = size;
+    height_px = size;
+    setup();
+
+    printf("{\n  \"suite\": \"bench_draw\",\n  \"backend\": \"%s\",\n  \"width\": %d,\n  \"height\": %d,\n"
+           "  \"results\": [", memory ? "memory" : "x11", width_px, height_px);
+
+    for (i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++){
+        if (filter != NULL && strstr(cases[i].name, filter) == NULL) continue;
+        n = (int)(cases[i].batch * scale);
+        if (n < 1) n = 1;
+        run_case(&cases[i], n, repeats, first);
+        first = 0;
+    }
+    printf("\n  ]\n}\n");
+
+    remove(tmp_xwd);
+    remove(tmp_bmp);
+    G_close();
+    return 0;
+}
@@ -0,0 +1,424 @@
+/**
+ * @file bench_math.c
+ * @brief Microbenchmarks for vector.c, vector_array.c, quaternion.c and M3d_matrix_tools.c.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * Build and run from the top of the tree:
+ *
+ *     gcc -O2 -march=native bench/bench_math.c vector.c vector_array.c quaternion.c -lm -o bench_math
+ *     ./bench_math > bench_output.txt
+ *
+ * Every routine is run over arrays of 16 up to 10^7 elements.  Each size gets one
+ * warm-up run followed by a number of timed runs, and each run repeats the routine
+ * until it has taken at least --min-ms milliseconds, so small sizes are not lost in
+ * timer noise.  Routines that work on one matrix at a time (M3d_mat_mult, the
+ * movement sequences) are reported with size 1.
+ *
+ * The results are printed as one JSON object on stdout; ns_per_op is the fastest
+ * run and ns_per_op_median the median, both per element.
+ *
+ * The inputs are shared between the routines and every output goes to one scratch
+ * buffer, about 180 bytes per element in all: 1.8 GB at the default --max-size.
+ * Use a smaller --max-size on machines with less memory.
+ *
+ * Options:
+ *     --max-size N    largest array size (default 10000000)
+ *     --repeats N     timed runs per size (default 5)
+ *     --min-ms N      minimum length of one timed run (default 10)
+ *     --filter TEXT   only run the routines whose name contains TEXT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../vector.h"
+#include "../vector_array.h"
+#include "../quaternion.h"
+#include "../M3d_matrix_tools.c"
+
+
+/* Data shared by all the benchmarks, sized for the largest run.  The Vector2 and
+   SoA double inputs are views of the Vector3 inputs, and the outputs all point
+   into one scratch buffer, since no routine reads what another one wrote. */
+
+static Vector3 *a3, *b3, *o3;
+static Vector2 *a2, *b2, *o2;
+static double *d_out, *xs, *ys, *zs, *X, *Y, *Z;
+static Vector3Array sa, sb, so;
+static Quaternion *qa, *qb, *qo;
+static double *qt;
+static float *xf, *yf, *zf, *Xf, *Yf, *Zf;
+static void *scratch;
+static double mat[4][4], mat2[4][4], mat_out[4][4], mat_inv[4][4];
+
+#define SEQ_LENGTH 8
+static int seq_types[SEQ_LENGTH] = {SX, SY, SZ, RX, RY, RZ, TX, TY};
+static double seq_params[SEQ_LENGTH] = {1.5, 0.5, 2.0, 30, 45, 60, 3, -4};
+static M3d_movement_sequence seq;
+
+// number of iterations used for the one-matrix-at-a-time routines
+#define FIXED_N 4096
+
+
+/* Benchmarked loops */
+
+#define BENCH_VEC_BINARY(name, a, b, o) \
+    static void b_##name(int n){ \
+        int i; \
+        for (i = 0; i < n; i++) o[i] = name(a[i], b[i]); \
+    }
+
+#define BENCH_VEC_UNARY(name, a, o) \
+    static void b_##name(int n){ \
+        int i; \
+        for (i = 0; i < n; i++) o[i] = name(a[i]); \
+    }
+
+BENCH_VEC_BINARY(vec3_add, a3, b3, o3)
+BENCH_VEC_BINARY(vec3_sub, a3, b3, o3)
+BENCH_VEC_BINARY(vec3_mult, a3, b3, o3)
+BENCH_VEC_BINARY(vec3_div, a3, b3, o3)
+BENCH_VEC_BINARY(vec3_cross_prod, a3, b3, o3)
+BENCH_VEC_BINARY(vec3_dot, a3, b3, d_out)
+BENCH_VEC_BINARY(vec3_distance, a3, b3, d_out)
+BENCH_VEC_BINARY(vec3_reflect, a3, b3, o3)
+BENCH_VEC_UNARY(vec3_magnitude, a3, d_out)
+BENCH_VEC_UNARY(vec3_normalized, a3, o3)
+BENCH_VEC_UNARY(vec3_normalized_fast, a3, o3)
+
+BENCH_VEC_BINARY(vec2_add, a2, b2, o2)
+BENCH_VEC_BINARY(vec2_sub, a2, b2, o2)
+BENCH_VEC_BINARY(vec2_mult, a2, b2, o2)
+BENCH_VEC_BINARY(vec2_div, a2, b2, o2)
+BENCH_VEC_BINARY(vec2_dot, a2, b2, d_out)
+BENCH_VEC_BINARY(vec2_distance, a2, b2, d_out)
+BENCH_VEC_BINARY(vec2_reflect, a2, b2, o2)
+BENCH_VEC_UNARY(vec2_magnitude, a2, d_out)
+BENCH_VEC_UNARY(vec2_normalized, a2, o2)
+BENCH_VEC_UNARY(vec2_normalized_fast, a2, o2)
+
+static void b_vec3_scale(int n){
+    int i;
+    for (i = 0; i < n; i++) o3[i] = vec3_scale(a3[i], 1.5);
+}
+
+static void b_vec3_lerp(int n){
+    int i;
+    for (i = 0; i < n; i++) o3[i] = vec3_lerp(a3[i], b3[i], 0.25);
+}
+
+static void b_vec3_madd(int n){
+    int i;
+    for (i = 0; i < n; i++) o3[i] = vec3_madd(a3[i], b3[i], a3[i]);
+}
+
+static void b_vec2_scale(int n){
+    int i;
+    for (i = 0; i < n; i++) o2[i] = vec2_scale(a2[i], 1.5);
+}
+
+static void b_vec2_lerp(int n){
+    int i;
+    for (i = 0; i < n; i++) o2[i] = vec2_lerp(a2[i], b2[i], 0.25);
+}
+
+static void b_vec3_add_batch(int n){ vec3_add_batch(o3, a3, b3, n); }
+static void b_vec3_cross_prod_batch(int n){ vec3_cross_prod_batch(o3, a3, b3, n); }
+static void b_vec3_normalized_batch(int n){ vec3_normalized_batch(o3, a3, n); }
+static void b_vec3_normalized_fast_batch(int n){ vec3_normalized_fast_batch(o3, a3, n); }
+
+// the Vector3Array kernels work on count elements, so set it for each call
+#define BENCH_SOA_BINARY(name) \
+    static void b_##name(int n){ \
+        sa.count = n; \
+        name(&so, &sa, &sb); \
+    }
+
+BENCH_SOA_BINARY(vec3_array_add)
+BENCH_SOA_BINARY(vec3_array_mult)
+BENCH_SOA_BINARY(vec3_array_cross)
+
+static void b_vec3_array_dot(int n){
+    sa.count = n;
+    vec3_array_dot(d_out, &sa, &sb);
+}
+
+static void b_vec3_array_normalize(int n){
+    sa.count = n;
+    vec3_array_normalize(&so, &sa);
+}
+
+static void b_vec3_array_normalize_fast(int n){
+    sa.count = n;
+    vec3_array_normalize_fast(&so, &sa);
+}
+
+static void b_vec3_array_transform_points(int n){
+    sa.count = n;
+    vec3_array_transform_points(&so, &sa, mat);
+}
+
+static void b_vec3_transform_points(int n){ vec3_transform_points(o3, a3, mat, n); }
+static void b_vec3_transform_normals(int n){ vec3_transform_normals(o3, a3, mat, n); }
+
+static void b_vec3_array_from_aos(int n){ vec3_array_from_aos(&so, a3, n); }
+
+static void b_vec3_array_to_aos(int n){
+    sa.count = n;
+    vec3_array_to_aos(o3, &sa);
+}
+
+static void b_quat_slerp_batch(int n){ quat_slerp_batch(qo, qa, qb, qt, n); }
+
+static void b_M3d_mat_mult_pt(int n){
+    // a Vector3 has the same layout as a double[3]
+    double (*p)[3] = (double (*)[3])o3, (*q)[3] = (double (*)[3])a3;
+    int i;
+    for (i = 0; i < n; i++) M3d_mat_mult_pt(p[i], mat, q[i]);
+}
+
+static void b_M3d_mat_mult_points(int n){ M3d_mat_mult_points(X, Y, Z, mat, xs, ys, zs, n); }
+
+static void b_M3d_mat_mult_points_f(int n){
+    float m[4][4];
+    M3d_mat_to_f(m, mat);
+    M3d_mat_mult_points_f(Xf, Yf, Zf, m, xf, yf, zf, n);
+}
+
+static void b_M3d_mat_mult(int n){
+    int i;
+    for (i = 0; i < n; i++) M3d_mat_mult(mat_out, mat, mat2);
+}
+
+static void b_M3d_make_movement_sequence_matrix(int n){
+    int i;
+    for (i = 0; i < n; i++) M3d_make_movement_sequence_matrix(mat_out, mat_inv, SEQ_LENGTH, seq_types, seq_params);
+}
+
+static void b_M3d_eval_movement_sequence(int n){
+    int i;
+    for (i = 0; i < n; i++){
+        // vary one angle so the trig cache is exercised on every other call
+        seq_params[3] = 30 + (i & 1);
+        M3d_eval_movement_sequence(mat_out, mat_inv, &seq, seq_params);
+    }
+}
+
+
+/* Registry */
+
+typedef struct Bench {
+    const char *name;
+    void (*run)(int n);
+    int fixed;  // 1 if the routine handles one matrix per call, not an array
+} Bench;
+
+#define B(name) {#name, b_##name, 0}
+#define B_FIXED(name) {#name, b_##name, 1}
+
+static Bench benches[] = {
+    B(vec3_add), B(vec3_sub), B(vec3_mult), B(vec3_div), B(vec3_scale),
+    B(vec3_cross_prod), B(vec3_dot), B(vec3_magnitude), B(vec3_normalized),
+    B(vec3_normalized_fast), B(vec3_lerp), B(vec3_reflect), B(vec3_distance), B(vec3_madd),
+    B(vec2_add), B(vec2_sub), B(vec2_mult), B(vec2_div), B(vec2_scale),
+    B(vec2_dot), B(vec2_magnitude), B(vec2_normalized), B(vec2_normalized_fast),
+    B(vec2_lerp), B(vec2_reflect), B(vec2_distance),
+    B(vec3_add_batch), B(vec3_cross_prod_batch), B(vec3_normalized_batch), B(vec3_normalized_fast_batch),
+    B(vec3_array_add), B(vec3_array_mult), B(vec3_array_cross), B(vec3_array_dot),
+    B(vec3_array_normalize), B(vec3_array_normalize_fast), B(vec3_array_transform_points),
+    B(vec3_transform_points), B(vec3_transform_normals), B(vec3_array_from_aos), B(vec3_array_to_aos),
+    B(quat_slerp_batch),
+    B(M3d_mat_mult_pt), B(M3d_mat_mult_points), B(M3d_mat_mult_points_f),
+    B_FIXED(M3d_mat_mult), B_FIXED(M3d_make_movement_sequence_matrix), B_FIXED(M3d_eval_movement_sequence),
+};
+
+static const int sizes[] = {16, 256, 4096, 65536, 1000000, 10000000};
+
+
+/* Setup */
+
+static double frand(double lo, double hi){
+    return lo + (hi - lo) * (rand() / (double)RAND_MAX);
+}
+
+static void *alloc_or_die(size_t bytes){
+    void *p = malloc(bytes);
+    if (p == NULL){
+        fprintf(stderr, "bench_math: out of memory (%zu bytes)\n", bytes);
+        exit(1);
+    }
+    return p;
+}
+
+static void setup(int max_size){
+    size_t n = (size_t)max_size;
+    size_t stride = (n + 3) & ~(size_t)3;  // keeps each scratch SoA array 32-byte aligned
+    int i;
+
+    a3 = alloc_or_die(n * sizeof(Vector3));
+    b3 = alloc_or_die(n * sizeof(Vector3));
+    // qb[i] is qa[i + 1], so n + 1 quaternions make n pairs
+    qa = alloc_or_die((n + 1) * sizeof(Quaternion));
+    qb = qa + 1;
+    qt = alloc_or_die(n * sizeof(double));
+    xf = alloc_or_die(3 * n * sizeof(float));
+    yf = xf + n;
+    zf = yf + n;
+    if (!vec3_array_init(&sa, max_size) || !vec3_array_init(&sb, max_size)){
+        fprintf(stderr, "bench_math: out of memory\n");
+        exit(1);
+    }
+
+    // the Vector2 inputs reuse the doubles of the Vector3 ones, and the SoA
+    // double inputs are the arrays of sa
+    a2 = (Vector2 *)a3;
+    b2 = (Vector2 *)b3;
+    xs = sa.x;
+    ys = sa.y;
+    zs = sa.z;
+
+    // one scratch buffer, 32-byte aligned for the SIMD stores into so,
+    // large enough for n Quaternion or three SoA double arrays
+    if (posix_memalign(&scratch, 32, 3 * stride * sizeof(double) + n * sizeof(double)) != 0){
+        fprintf(stderr, "bench_math: out of memory\n");
+        exit(1);
+    }
+    o3 = scratch;
+    o2 = scratch;
+    d_out = scratch;
+    qo = scratch;
+    X = scratch;
+    Y = X + stride;
+    Z = Y + stride;
+    Xf = scratch;
+    Yf = Xf + n;
+    Zf = Yf + n;
+    // so is never grown or freed, so its arrays can live in the scratch buffer
+    so.x = X;
+    so.y = Y;
+    so.z = Z;
+    so.count = 0;
+    so.capacity = max_size;
+
+    srand(1);
+    for (i = 0; i < max_size; i++){
+        // b stays away from zero so that the divisions are well defined
+        a3[i].x = frand(-1, 1); a3[i].y = frand(-1, 1); a3[i].z = frand(-1, 1);
+        b3[i].x = frand(0.5, 1.5); b3[i].y = frand(0.5, 1.5); b3[i].z = frand(0.5, 1.5);
+        xf[i] = a3[i].x; yf[i] = a3[i].y; zf[i] = a3[i].z;
+        vec3_array_set(&sa, i, a3[i]);
+        vec3_array_set(&sb, i, b3[i]);
+        qa[i] = quat_from_axis_angle(a3[i], frand(0, 3));
+        qt[i] = frand(0, 1);
+    }
+    qa[max_size] = quat_from_axis_angle(b3[0], frand(0, 3));
+    sa.count = max_size;
+    sb.count = max_size;
+
+    M3d_make_movement_sequence_matrix(mat, mat_inv, SEQ_LENGTH, seq_types, seq_params);
+    M3d_make_y_rotation_cs(mat2, cos(0.3), sin(0.3));
+    M3d_compile_movement_sequence(&seq, SEQ_LENGTH, seq_types);
+}
+
+
+/* Timing */
+
+static double now_seconds(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int compare_doubles(const void *a, const void *b){
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Times one routine at one size and prints its JSON record.
+ * Returns the fastest time per element in nanoseconds.
+ */
+static double run_bench(const Bench *b, int n, int repeats, double min_seconds, int first){
+    double samples[64];
+    double t, start;
+    long reps = 1, r;
+    int k;
+
+    // warm up the caches and find how many calls make one run of min_seconds
+    for (;;){
+        start = now_seconds();
+        for (r = 0; r < reps; r++) b->run(n);
+        t = now_seconds() - start;
+        if (t >= min_seconds || reps >= (1L << 30)) break;
+        reps = (t <= 0) ? reps * 16 : (long)(reps * 1.2 * min_seconds / t) + 1;
+    }
+
+    for (k = 0; k < repeats; k++){
+        start = now_seconds();
+        for (r = 0; r < reps; r++) b->run(n);
+        samples[k] = (now_seconds() - start) * 1e9 / ((double)reps * n);
+    }
+    qsort(samples, repeats, sizeof(double), compare_doubles);
+
+    printf("%s\n    {\"name\": \"%s\", \"size\": %d, \"repeats\": %d, \"calls_per_run\": %ld, "
+           "\"ns_per_op\": %.4f, \"ns_per_op_median\": %.4f, \"elements_per_sec\": %.6g}",
+           first ? "" : ",", b->name, b->fixed ? 1 : n, repeats, reps,
+           samples[0], samples[repeats / 2], 1e9 / samples[0]);
+    fflush(stdout);
+    return samples[0];
+}
+
+static const char *simd_name(void){
+#if defined(__AVX__)
+    return "avx";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "none";
+#endif
+}
+
+int main(int argc, char **argv){
+    int max_size = 10000000, repeats = 5, min_ms = 10;
+    const char *filter = NULL;
+    int i, s, first = 1;
+    size_t nb = sizeof(benches) / sizeof(benches[0]);
+
+    for (i = 1; i < argc; i++){
+        if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) max_size = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--repeats") == 0 && i + 1 < argc) repeats = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--min-ms") == 0 && i + 1 < argc) min_ms = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [--max-size N] [--repeats N] [--min-ms N] [--filter TEXT]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (max_size < FIXED_N) max_size = FIXED_N;
+    if (repeats < 1) repeats = 1;
+    if (repeats > 64) repeats = 64;
+
+    setup(max_size);
+
+    printf("{\n  \"suite\": \"bench_math\",\n  \"compiler\": \"%s\",\n  \"simd\": \"%s\",\n"
+           "  \"max_size\": %d,\n  \"min_ms\": %d,\n  \"results\": [",
+           __VERSION__, simd_name(), max_size, min_ms);
+
+    for (i = 0; i < (int)nb; i++){
+        if (filter != NULL && strstr(benches[i].name, filter) == NULL) continue;
+        if (benches[i].fixed){
+            run_bench(&benches[i], FIXED_N, repeats, min_ms * 1e-3, first);
+            first = 0;
+            continue;
+        }
+        for (s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])) && sizes[s] <= max_size; s++){
+            run_bench(&benches[i], sizes[s], repeats, min_ms * 1e-3, first);
+            first = 0;
+        }
+    }
+    printf("\n  ]\n}\n");
+    return 0;
+}
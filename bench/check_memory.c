@@ -0,0 +1,101 @@
+/**
+ * @file check_memory.c
+ * @brief Edge cases of the in-memory backend of FPToolkit.c, for running under
+ *        the address and undefined behavior sanitizers.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * Build and run from the top of the tree; no X server is needed:
+ *
+ *     gcc -g -O1 -fsanitize=address,undefined -fno-sanitize-recover=all \
+ *         bench/check_memory.c -lm -lX11 -o check_memory
+ *     ./check_memory
+ *
+ * Each check draws shapes that reach past the edges of the buffer.  A write or
+ * read outside it stops the program with a sanitizer report; otherwise every
+ * check prints "ok" and the exit status is 0.
+ */
+
+#include "../FPToolkit.c"
+
+
+#define WIDTH  200
+#define HEIGHT 150
+
+
+// antialiased triangles with a vertex left of (or right of, or above,
+// or below) the window, so that their edges end on its bounds
+static void check_cover_edges(void){
+    double x[3], y[3];
+    int i, k;
+
+    G_antialias(1);
+    srand48(1);
+    for (i = 0; i < 20000; i++){
+        for (k = 0; k < 3; k++){
+            x[k] = -60 + drand48() * (WIDTH + 120);
+            y[k] = -60 + drand48() * (HEIGHT + 120);
+        }
+        x[i % 3] = -drand48() * 50;  // crosses x = 0
+        G_rgb(drand48(), drand48(), drand48());
+        G_fill_polygon(x, y, 3);
+    }
+    G_antialias(0);
+    printf("cover edges ok\n");
+}
+
+
+// translucent shaded triangles whose last block of 4 pixels is cut
+// short by the right edge of the bottom row
+static void check_triangle_blocks(void){
+    double x[3] = {185, 199.9, 199.9}, y[3] = {-1, -1, 5};
+    double rgb[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    int i;
+
+    G_rgba(1, 0, 0, 0.5);
+    G_fill_triangle_rgb(x, y, rgb);
+    for (i = 0; i < 1000; i++){
+        x[0] = WIDTH - 1 - drand48() * 40;
+        x[1] = x[2] = WIDTH - drand48() * 3;
+        y[0] = y[1] = -drand48() * 3;
+        y[2] = drand48() * 10;
+        G_fill_triangle_rgb(x, y, rgb);
+    }
+    G_rgb(0, 0, 0);
+    printf("triangle blocks ok\n");
+}
+
+
+// ellipses too large for the midpoint decision values, and centers
+// far enough off the window to overflow an int
+static void check_large_ellipses(void){
+    static const double e[][4] = {
+        {100, 100, 60000, 30000}, {100, 100, 3e6, 2e6}, {-59000, 75, 60000, 100},
+        {1e12, 75, 10, 10}, {100, -1e12, 10, 10}, {-2e9, 75, 2e9 + 50, 300},
+        {100, 75, 1e10, 1e10}, {100, 75, 5e9, 0}, {100, 75, 0, 5e9}
+    };
+    int i;
+
+    for (i = 0; i < (int)(sizeof(e) / sizeof(e[0])); i++){
+        G_fill_ellipse(e[i][0], e[i][1], e[i][2], e[i][3]);
+        G_ellipse(e[i][0], e[i][1], e[i][2], e[i][3]);
+    }
+    G_set_clip_rect(20, 30, 40, 50);
+    G_fill_ellipse(100, 100, 60000, 30000);
+    G_ellipse(100, 100, 60000, 30000);
+    G_clear_clip();
+    printf("large ellipses ok\n");
+}
+
+
+int main(void){
+    G_init_graphics_memory(WIDTH, HEIGHT);
+    G_rgb(1, 1, 1);
+    G_clear();
+
+    check_cover_edges();
+    check_triangle_blocks();
+    check_large_ellipses();
+
+    return 0;
+}
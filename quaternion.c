@@ -0,0 +1,167 @@
+#include "quaternion.h"
+#include <math.h>
+#include <stdio.h>
+
+
+/* Coefficients for quat_slerp, see D. Eberly, "A Fast and Accurate Algorithm
+   for Computing SLERP".  u[i] = 1/(i(2i+1)) and v[i] = i/(2i+1) for i = 1..8,
+   with the last pair scaled by mu = 1.85298109240830 to absorb the truncated tail. */
+
+#define QUAT_SLERP_MU 1.85298109240830
+
+static const double slerp_u[8] = {
+    1.0/(1*3), 1.0/(2*5), 1.0/(3*7), 1.0/(4*9),
+    1.0/(5*11), 1.0/(6*13), 1.0/(7*15), QUAT_SLERP_MU/(8*17)
+};
+
+static const double slerp_v[8] = {
+    1.0/3, 2.0/5, 3.0/7, 4.0/9,
+    5.0/11, 6.0/13, 7.0/15, QUAT_SLERP_MU*8/17
+};
+
+
+void quat_print(Quaternion q){
+    printf("<%lf, %lf, %lf, %lf>\n", q.w, q.x, q.y, q.z);
+}
+
+Quaternion quat_identity(void){
+    Quaternion result;
+    result.w = 1;
+    result.x = 0;
+    result.y = 0;
+    result.z = 0;
+    return result;
+}
+
+Quaternion quat_from_axis_angle(Vector3 axis, double radians){
+    double length = sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+    double s;
+    Quaternion result;
+    if (length == 0){
+        return quat_identity();
+    }
+    s = sin(0.5 * radians) / length;
+    result.w = cos(0.5 * radians);
+    result.x = axis.x * s;
+    result.y = axis.y * s;
+    result.z = axis.z * s;
+    return result;
+}
+
+Quaternion quat_mult(Quaternion a, Quaternion b){
+    Quaternion result;
+    result.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+    result.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+    result.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+    result.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+    return result;
+}
+
+Quaternion quat_conjugate(Quaternion q){
+    Quaternion result;
+    result.w = q.w;
+    result.x = -q.x;
+    result.y = -q.y;
+    result.z = -q.z;
+    return result;
+}
+
+double quat_dot(Quaternion a, Quaternion b){
+    return a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+void quat_normalize(Quaternion *q){
+    double inv = 1.0 / sqrt(quat_dot(*q, *q));
+    q->w *= inv;
+    q->x *= inv;
+    q->y *= inv;
+    q->z *= inv;
+}
+
+Quaternion quat_normalized(Quaternion q){
+    quat_normalize(&q);
+    return q;
+}
+
+Vector3 quat_rotate_vec3(Quaternion q, Vector3 v){
+    // v' = v + w*t + u x t  where u = (x,y,z) and t = 2 u x v
+    double tx = 2 * (q.y * v.z - q.z * v.y);
+    double ty = 2 * (q.z * v.x - q.x * v.z);
+    double tz = 2 * (q.x * v.y - q.y * v.x);
+    Vector3 result;
+    result.x = v.x + q.w * tx + (q.y * tz - q.z * ty);
+    result.y = v.y + q.w * ty + (q.z * tx - q.x * tz);
+    result.z = v.z + q.w * tz + (q.x * ty - q.y * tx);
+    return result;
+}
+
+void quat_to_matrix(double out[4][4], Quaternion q){
+    double xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    double xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    double wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    out[0][0] = 1 - 2 * (yy + zz);
+    out[0][1] = 2 * (xy - wz);
+    out[0][2] = 2 * (xz + wy);
+    out[0][3] = 0;
+
+    out[1][0] = 2 * (xy + wz);
+    out[1][1] = 1 - 2 * (xx + zz);
+    out[1][2] = 2 * (yz - wx);
+    out[1][3] = 0;
+
+    out[2][0] = 2 * (xz - wy);
+    out[2][1] = 2 * (yz + wx);
+    out[2][2] = 1 - 2 * (xx + yy);
+    out[2][3] = 0;
+
+    out[3][0] = 0;
+    out[3][1] = 0;
+    out[3][2] = 0;
+    out[3][3] = 1;
+}
+
+Quaternion quat_slerp(Quaternion a, Quaternion b, double t){
+    double x = quat_dot(a, b);
+    double sign = 1;
+    double xm1, d, tt, dd, ct, cd;
+    int i;
+    Quaternion result;
+
+    // take the shorter arc so that x = cos(theta) is in [0, 1]
+    if (x < 0){
+        x = -x;
+        sign = -1;
+    }
+
+    xm1 = x - 1;
+    d = 1 - t;
+    tt = t * t;
+    dd = d * d;
+
+    // Horner evaluation of sum b_i * (x-1)^i for both weights
+    ct = 1;
+    cd = 1;
+    for (i = 7; i >= 0; i--){
+        ct = 1 + ct * (slerp_u[i] * tt - slerp_v[i]) * xm1;
+        cd = 1 + cd * (slerp_u[i] * dd - slerp_v[i]) * xm1;
+    }
+    ct *= t * sign;
+    cd *= d;
+
+    result.w = cd * a.w + ct * b.w;
+    result.x = cd * a.x + ct * b.x;
+    result.y = cd * a.y + ct * b.y;
+    result.z = cd * a.z + ct * b.z;
+
+    // the truncated series is off length by up to ~3e-5; one sqrt fixes that
+    quat_normalize(&result);
+    return result;
+}
+
+void quat_slerp_batch(Quaternion out[], const Quaternion a[], const Quaternion b[], const double t[], int n){
+    int i;
+    for (i = 0; i < n; i++){
+        out[i] = quat_slerp(a[i], b[i], t[i]);
+    }
+}
@@ -0,0 +1,152 @@
+/**
+ * @file quaternion.h
+ * @brief Unit quaternions for representing and interpolating 3D rotations.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * Composing quaternions instead of rotation matrices keeps incremental
+ * animation from drifting: a quaternion is renormalized with one square root,
+ * and quat_to_matrix turns it into the double[4][4] layout used by
+ * M3d_matrix_tools.c whenever points need to be transformed.
+ */
+
+#ifndef QUATERNION_H
+#define QUATERNION_H
+
+#include "vector.h"
+
+
+/**
+ * @struct Quaternion
+ * @brief Represents the quaternion w + xi + yj + zk.
+ */
+typedef struct Quaternion {
+    double w;
+    double x;
+    double y;
+    double z;
+} Quaternion;
+
+/**
+ * Prints the components of a Quaternion.
+ *
+ * @param q The Quaternion to be printed.
+ */
+void quat_print(Quaternion q);
+
+/**
+ * Returns the identity rotation (1, 0, 0, 0).
+ *
+ * @return The identity Quaternion.
+ */
+Quaternion quat_identity(void);
+
+/**
+ * Makes the rotation of a given angle about a given axis.
+ *
+ * A zero axis has no direction to turn about, so it gives the identity,
+ * as the fast normalizations keep a zero vector zero.
+ *
+ * @param axis The rotation axis; it does not need to be normalized.
+ * @param radians The rotation angle, right-handed about the axis.
+ * @return The unit Quaternion for the rotation, or the identity for a zero axis.
+ */
+Quaternion quat_from_axis_angle(Vector3 axis, double radians);
+
+/**
+ * Multiplies two quaternions (Hamilton product).
+ *
+ * The result rotates by b first and then by a, the same order as
+ * M3d_mat_mult(res, A, B) for the matching matrices.
+ *
+ * @param a The second rotation.
+ * @param b The first rotation.
+ * @return The product a * b.
+ */
+Quaternion quat_mult(Quaternion a, Quaternion b);
+
+/**
+ * Returns the conjugate of a quaternion, which is the inverse rotation when q is a unit quaternion.
+ *
+ * @param q The quaternion.
+ * @return The conjugate (w, -x, -y, -z).
+ */
+Quaternion quat_conjugate(Quaternion q);
+
+/**
+ * Calculates the 4D dot product of two quaternions.
+ *
+ * @param a The first quaternion.
+ * @param b The second quaternion.
+ * @return The dot product, the cosine of half the angle between the rotations.
+ */
+double quat_dot(Quaternion a, Quaternion b);
+
+/**
+ * @brief Normalize a quaternion in place.
+ *
+ * Call this every so often on quaternions that are composed frame after frame
+ * to remove accumulated rounding drift.
+ *
+ * @param q Pointer to the quaternion to be normalized.
+ */
+void quat_normalize(Quaternion *q);
+
+/**
+ * Returns a normalized copy of a quaternion.
+ *
+ * @param q The quaternion to be normalized.
+ * @return The unit-length quaternion.
+ */
+Quaternion quat_normalized(Quaternion q);
+
+/**
+ * Rotates a 3D vector by a unit quaternion.
+ *
+ * @param q The rotation.
+ * @param v The vector to rotate.
+ * @return The rotated vector.
+ */
+Vector3 quat_rotate_vec3(Quaternion q, Vector3 v);
+
+/**
+ * Converts a unit quaternion to a 4x4 rotation matrix.
+ *
+ * The matrix uses the same column-vector convention as M3d_matrix_tools.c, so it
+ * can be passed straight to M3d_mat_mult, M3d_mat_mult_pt or M3d_mat_mult_points.
+ *
+ * @param out The output matrix.
+ * @param q The rotation.
+ */
+void quat_to_matrix(double out[4][4], Quaternion q);
+
+/**
+ * Spherical linear interpolation between two rotations, without trig calls.
+ *
+ * Uses Eberly's polynomial form of sin(t*theta)/sin(theta) (eight terms, corrected
+ * last coefficient), so no acos or sin is needed, only one square root to
+ * renormalize. The shorter arc is always taken. For unit inputs the result
+ * differs from exact SLERP by less than 1e-5 in each component.
+ *
+ * @param a The rotation at t = 0.
+ * @param b The rotation at t = 1.
+ * @param t The interpolation parameter in [0, 1].
+ * @return The interpolated rotation.
+ */
+Quaternion quat_slerp(Quaternion a, Quaternion b, double t);
+
+/**
+ * Interpolates many rotations at once with the same method as quat_slerp.
+ *
+ * out[i] = quat_slerp(a[i], b[i], t[i]) for i in [0, n). out may alias a or b.
+ *
+ * @param out The interpolated rotations.
+ * @param a The rotations at t = 0.
+ * @param b The rotations at t = 1.
+ * @param t The interpolation parameter of each rotation.
+ * @param n The number of rotations.
+ */
+void quat_slerp_batch(Quaternion out[], const Quaternion a[], const Quaternion b[], const double t[], int n);
+
+
+#endif
@@ -1,3 +1,9 @@
+// Every function in vector.h except the print functions is defined there as
+// VECTOR_INLINE so that callers can inline it.  Defining VECTOR_INLINE as
+// "extern inline" here makes this file emit the one external definition of
+// each of them (C99 inline rules) for calls the compiler chooses not to inline.
+#define VECTOR_INLINE extern inline
+
 #include "vector.h"
 #include <math.h>
 #include <stdio.h>
@@ -9,123 +15,111 @@ void vec3_print(Vector3 v){
     printf("<%lf, %lf, %lf>\n", v.x, v.y, v.z);
 }
 
-double vec3_magnitude(Vector3 v){
-    return sqrt(pow(v.x, 2) + pow(v.y, 2) + pow(v.z, 2));
-}
+/* 2D Vector Functions */
 
-void vec3_normalize(Vector3 *v){
-    double magnitude = vec3_magnitude(*v);
-    v->x /= magnitude;
-    v->y /= magnitude;
-    v->z /= magnitude;
+void vec2_print(Vector2 v){
+    printf("<%lf, %lf>\n", v.x, v.y);
 }
 
-Vector3 vec3_normalized(Vector3 v){
-    double magnitude = vec3_magnitude(v);
-    Vector3 result;
-    result.x = v.x / magnitude;
-    result.y = v.y / magnitude;
-    result.z = v.z / magnitude;
-    return result;
-}
+/* Batch forms */
 
-Vector3 vec3_add(Vector3 a, Vector3 b){
-    Vector3 result;
-    result.x = a.x + b.x;
-    result.y = a.y + b.y;
-    result.z = a.z + b.z;
-    return result;
+void vec3_add_batch(Vector3 out[], const Vector3 a[], const Vector3 b[], int n){
+    int i;
+    for (i = 0; i < n; i++){
+        out[i] = vec3_add(a[i], b[i]);
+    }
 }
 
-Vector3 vec3_sub(Vector3 a, Vector3 b){
-    Vector3 result;
-    result.x = a.x - b.x;
-    result.y = a.y - b.y;
-    result.z = a.z - b.z;
-    return result;
+void vec3_sub_batch(Vector3 out[], const Vector3 a[], const Vector3 b[], int n){
+    int i;
+    for (i = 0; i < n; i++){
+        out[i] = vec3_sub(a[i], b[i]);
+    }
 }
 
-Vector3 vec3_mult(Vector3 a, Vector3 b){
-    Vector3 result;
-    result.x = a.x * b.x;
-    result.y = a.y * b.y;
-    result.z = a.z * b.z;
-    return result;
+void vec3_mult_batch(Vector3 out[], const Vector3 a[], const Vector3 b[], int n){
+    int i;
+    for (i = 0; i < n; i++){
+        out[i] = vec3_mult(a[i], b[i]);
+    }
 }
 
-Vector3 vec3_div(Vector3 a, Vector3 b){
-    Vector3 result;
-    result.x = a.x / b.x;
-    result.y = a.y / b.y;
-    result.z = a.z / b.z;
-    return result;
+void vec3_div_batch(Vector3 out[], const Vector3 a[], const Vector3 b[], int n){
+    int i;
+    for (i = 0; i < n; i++){
+        out[i] = vec3_div(a[i], b[i]);
+    }
 }
 
-Vector3 vec3_cross_prod(Vector3 a, Vector3 b){
-    Vector3 result;
-    result.x = (a.y * b.z) - (b.y * a.z);
-    result.y = (a.x * b.z) - (b.x * a.z);
-    result.z = (a.x * b.y) - (b.x * a.y);
-    return result;
+void vec3_scale_batch(Vector3 out[], const Vector3 a[], double scale, int n){
+    int i;
+    for (i = 0; i < n; i++){
+        out[i] = vec3_scale(a[i], scale);
+    }
 }
 
-/* 2D Vector Functions */
-
-void vec2_print(Vector2 v){
-    printf("<%lf, %lf>\n", v.x, v.y);
+void vec3_cross_prod_batch(Vector3 out[], const Vector3 a[], const Vector3 b[], int n){
+    int i;
+    for (i = 0; i < n; i++){
+        out[i] = vec3_cross_prod(a[i], b[i]);
+    }
 }
 
-double vec2_magnitude(Vector2 v){
-    return sqrt(pow(v.x, 2) + pow(v.y, 2));
+void vec3_dot_batch(double out[], const Vector3 a[], const Vector3 b[], int n){
+    int i;
+    for (i = 0; i < n; i++){
+        out[i] = vec3_dot(a[i], b[i]);
+    }
 }
 
-void vec2_normalize(Vector2 *v){
-    double magnitude = vec2_magnitude(*v);
-    v->x /= magnitude;
-    v->y /= magnitude;
+void vec3_magnitude_batch(double out[], const Vector3 a[], int n){
+    int i;
+    for (i = 0; i < n; i++){
+        out[i] = vec3_magnitude(a[i]);
+    }
 }
 
-Vector2 vec2_normalized(Vector2 v){
-    double magnitude = vec2_magnitude(v);
-    Vector2 result;
-    result.x = v.x / magnitude;
-    result.y = v.y / magnitude;
-    return result;
+void vec3_normalized_batch(Vector3 out[], const Vector3 a[], int n){
+    int i;
+    for (i = 0; i < n; i++){
+        out[i] = vec3_normalized(a[i]);
+    }
 }
 
-Vector2 vec2_add(Vector2 a, Vector2 b){
-    Vector2 result;
-    result.x = a.x + b.x;
-    result.y = a.y + b.y;
-    return result;
+void vec3_normalized_fast_batch(Vector3 out[], const Vector3 a[], int n){
+    int i;
+    for (i = 0; i < n; i++){
+        out[i] = vec3_normalized_fast(a[i]);
+    }
 }
 
-Vector2 vec2_sub(Vector2 a, Vector2 b){
-    Vector2 result;
-    result.x = a.x - b.x;
-    result.y = a.y - b.y;
-    return result;
+void vec3_lerp_batch(Vector3 out[], const Vector3 a[], const Vector3 b[], double t, int n){
+    int i;
+    for (i = 0; i < n; i++){
+        out[i] = vec3_lerp(a[i], b[i], t);
+    }
 }
 
-Vector2 vec2_mult(Vector2 a, Vector2 b){
-    Vector2 result;
-    result.x = a.x * b.x;
-    result.y = a.y * b.y;
-    return result;
+void vec3_reflect_batch(Vector3 out[], const Vector3 v[], const Vector3 normal[], int n){
+    int i;
+    for (i = 0; i < n; i++){
+        out[i] = vec3_reflect(v[i], normal[i]);
+    }
 }
 
-Vector2 vec2_div(Vector2 a, Vector2 b){
-    Vector2 result;
-    result.x = a.x / b.x;
-    result.y = a.y / b.y;
-    return result;
+void vec3_distance_batch(double out[], const Vector3 a[], const Vector3 b[], int n){
+    int i;
+    for (i = 0; i < n; i++){
+        out[i] = vec3_distance(a[i], b[i]);
+    }
 }
 
-Vector2 vec2_scale(Vector2 v, double scale){
-    Vector2 result;
-    result.x = v.x * scale;
-    result.y = v.y * scale;
-    return result;
-}
+/* Single precision Vector Functions */
 
+void vec3f_print(Vector3f v){
+    printf("<%f, %f, %f>\n", v.x, v.y, v.z);
+}
 
+void vec2f_print(Vector2f v){
+    printf("<%f, %f>\n", v.x, v.y);
+}
@@ -9,6 +9,48 @@
 #ifndef VECTOR_H
 #define VECTOR_H
 
+#include <math.h>
+#include <float.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+/*
+ * The operations below are defined in this header so that the compiler can inline
+ * them and fuse chains of them into straight-line code.  vector.c supplies the one
+ * out-of-line copy of each (see the note there), so linking against it is unchanged.
+ */
+#ifndef VECTOR_INLINE
+#define VECTOR_INLINE inline
+#endif
+
+/**
+ * Fast approximate reciprocal square root, 1/sqrt(x), for the *_fast normalizers.
+ *
+ * With SSE this is the hardware rsqrtss estimate refined by one Newton step in
+ * double, giving a relative error below 3e-7.  Without SSE it starts from the
+ * usual bit-pattern guess and takes two Newton steps, for a relative error below 5e-6.
+ * x = 0 returns a large finite value (never inf), so 0 * vec_rsqrt_fast(0) is 0.
+ * The bound holds for x in [FLT_MIN, FLT_MAX], i.e. vector lengths in about [1e-19, 1e19].
+ *
+ * @param x The value, normally a squared vector length.
+ * @return An approximation of 1/sqrt(x).
+ */
+VECTOR_INLINE double vec_rsqrt_fast(double x){
+    double y;
+#if defined(__SSE__)
+    // clamping to FLT_MIN keeps the estimate finite for x = 0
+    y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_max_ss(_mm_set_ss((float)x), _mm_set_ss(FLT_MIN))));
+#else
+    union { double d; unsigned long long i; } u;
+    u.d = x;
+    u.i = 0x5fe6eb50c7b537a9ULL - (u.i >> 1);
+    y = u.d;
+    y = y * (1.5 - 0.5 * x * y * y);
+#endif
+    return y * (1.5 - 0.5 * x * y * y);
+}
+
 
 /**
  * @struct Vector3
@@ -33,7 +75,9 @@ void vec3_print(Vector3 v);
  * @param v The vector for which to calculate the magnitude.
  * @return The magnitude of the vector.
  */
-double vec3_magnitude(Vector3 v);
+VECTOR_INLINE double vec3_magnitude(Vector3 v){
+    return sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+}
 
 /**
  * @brief Normalize a 3D vector.
@@ -42,7 +86,12 @@ double vec3_magnitude(Vector3 v);
  *
  * @param v Pointer to the Vector3 structure representing the vector to be normalized.
  */
-void vec3_normalize(Vector3 *v);
+VECTOR_INLINE void vec3_normalize(Vector3 *v){
+    double inv = 1 / vec3_magnitude(*v);
+    v->x *= inv;
+    v->y *= inv;
+    v->z *= inv;
+}
 
 /**
  * Normalizes a Vector3.
@@ -53,7 +102,43 @@ void vec3_normalize(Vector3 *v);
  * @param v The Vector3 to be normalized.
  * @return The normalized Vector3.
  */
-Vector3 vec3_normalized(Vector3 v);
+VECTOR_INLINE Vector3 vec3_normalized(Vector3 v){
+    double inv = 1 / vec3_magnitude(v);
+    Vector3 result;
+    result.x = v.x * inv;
+    result.y = v.y * inv;
+    result.z = v.z * inv;
+    return result;
+}
+
+/**
+ * Normalizes a 3D vector in place using vec_rsqrt_fast.
+ *
+ * One approximate reciprocal square root and three multiplies instead of a
+ * square root and a divide. The length of the result is within 3e-7 of 1
+ * (5e-6 without SSE). A zero vector stays zero, with no branch.
+ *
+ * @param v Pointer to the vector to be normalized.
+ */
+VECTOR_INLINE void vec3_normalize_fast(Vector3 *v){
+    double inv = vec_rsqrt_fast(v->x * v->x + v->y * v->y + v->z * v->z);
+    v->x *= inv;
+    v->y *= inv;
+    v->z *= inv;
+}
+
+/**
+ * Returns a normalized copy of a 3D vector using vec_rsqrt_fast.
+ *
+ * Same accuracy and zero handling as vec3_normalize_fast.
+ *
+ * @param v The vector to be normalized.
+ * @return The approximately unit-length vector, or zero for a zero vector.
+ */
+VECTOR_INLINE Vector3 vec3_normalized_fast(Vector3 v){
+    vec3_normalize_fast(&v);
+    return v;
+}
 
 /**
  * Adds two 3D vectors.
@@ -62,7 +147,13 @@ Vector3 vec3_normalized(Vector3 v);
  * @param b The second vector.
  * @return The sum of the two vectors.
  */
-Vector3 vec3_add(Vector3 a, Vector3 b);
+VECTOR_INLINE Vector3 vec3_add(Vector3 a, Vector3 b){
+    Vector3 result;
+    result.x = a.x + b.x;
+    result.y = a.y + b.y;
+    result.z = a.z + b.z;
+    return result;
+}
 
 /**
  * Subtracts two vectors.
@@ -71,7 +162,13 @@ Vector3 vec3_add(Vector3 a, Vector3 b);
  * @param b The second vector.
  * @return The resulting vector after subtracting b from a.
  */
-Vector3 vec3_sub(Vector3 a, Vector3 b);
+VECTOR_INLINE Vector3 vec3_sub(Vector3 a, Vector3 b){
+    Vector3 result;
+    result.x = a.x - b.x;
+    result.y = a.y - b.y;
+    result.z = a.z - b.z;
+    return result;
+}
 
 /**
  * Multiplies two Vector3 objects element-wise.
@@ -80,7 +177,13 @@ Vector3 vec3_sub(Vector3 a, Vector3 b);
  * @param b The second Vector3 object.
  * @return The resulting Vector3 object after element-wise multiplication.
  */
-Vector3 vec3_mult(Vector3 a, Vector3 b);
+VECTOR_INLINE Vector3 vec3_mult(Vector3 a, Vector3 b){
+    Vector3 result;
+    result.x = a.x * b.x;
+    result.y = a.y * b.y;
+    result.z = a.z * b.z;
+    return result;
+}
 
 /**
  * Divides two vectors element-wise.
@@ -89,15 +192,28 @@ Vector3 vec3_mult(Vector3 a, Vector3 b);
  * @param b The second vector.
  * @return The resulting vector after element-wise division.
  */
-Vector3 vec3_div(Vector3 a, Vector3 b);
+VECTOR_INLINE Vector3 vec3_div(Vector3 a, Vector3 b){
+    Vector3 result;
+    result.x = a.x / b.x;
+    result.y = a.y / b.y;
+    result.z = a.z / b.z;
+    return result;
+}
 
 /**
  * Scales a Vector3 by a given scale factor.
  *
+ * @param v The Vector3 to scale.
  * @param scale The scale factor to multiply the Vector3 by.
  * @return The scaled Vector3.
  */
-Vector3 vec3_scale(double scale);
+VECTOR_INLINE Vector3 vec3_scale(Vector3 v, double scale){
+    Vector3 result;
+    result.x = v.x * scale;
+    result.y = v.y * scale;
+    result.z = v.z * scale;
+    return result;
+}
 
 /**
  * Calculates the cross product of two 3D vectors.
@@ -106,7 +222,149 @@ Vector3 vec3_scale(double scale);
  * @param b The second vector.
  * @return The cross product of the two vectors.
  */
-Vector3 vec3_cross_prod(Vector3 a, Vector3 b);
+VECTOR_INLINE Vector3 vec3_cross_prod(Vector3 a, Vector3 b){
+    Vector3 result;
+    result.x = (a.y * b.z) - (b.y * a.z);
+    result.y = (b.x * a.z) - (a.x * b.z);
+    result.z = (a.x * b.y) - (b.x * a.y);
+    return result;
+}
+
+/**
+ * Calculates the dot product of two 3D vectors.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @return a . b
+ */
+VECTOR_INLINE double vec3_dot(Vector3 a, Vector3 b){
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+/**
+ * Linearly interpolates between two 3D vectors.
+ *
+ * @param a The vector at t = 0.
+ * @param b The vector at t = 1.
+ * @param t The interpolation parameter.
+ * @return a + t * (b - a)
+ */
+VECTOR_INLINE Vector3 vec3_lerp(Vector3 a, Vector3 b, double t){
+    Vector3 result;
+    result.x = a.x + t * (b.x - a.x);
+    result.y = a.y + t * (b.y - a.y);
+    result.z = a.z + t * (b.z - a.z);
+    return result;
+}
+
+/**
+ * Reflects a 3D vector about a plane with the given normal.
+ *
+ * @param v The incoming vector, e.g. a light or view direction.
+ * @param n The unit normal of the surface.
+ * @return v - 2 (v . n) n
+ */
+VECTOR_INLINE Vector3 vec3_reflect(Vector3 v, Vector3 n){
+    double d = 2 * (v.x * n.x + v.y * n.y + v.z * n.z);
+    Vector3 result;
+    result.x = v.x - d * n.x;
+    result.y = v.y - d * n.y;
+    result.z = v.z - d * n.z;
+    return result;
+}
+
+/**
+ * Calculates the distance between two 3D points.
+ *
+ * @param a The first point.
+ * @param b The second point.
+ * @return |a - b|
+ */
+VECTOR_INLINE double vec3_distance(Vector3 a, Vector3 b){
+    double dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+    return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+/**
+ * Adds b to a in place (a += b).
+ *
+ * @param a Pointer to the vector being accumulated.
+ * @param b The vector to add.
+ */
+VECTOR_INLINE void vec3_add_to(Vector3 *a, Vector3 b){
+    a->x += b.x;
+    a->y += b.y;
+    a->z += b.z;
+}
+
+/**
+ * Subtracts b from a in place (a -= b).
+ *
+ * @param a Pointer to the vector being accumulated.
+ * @param b The vector to subtract.
+ */
+VECTOR_INLINE void vec3_sub_from(Vector3 *a, Vector3 b){
+    a->x -= b.x;
+    a->y -= b.y;
+    a->z -= b.z;
+}
+
+/**
+ * Scales a vector in place (a *= scale).
+ *
+ * @param a Pointer to the vector to scale.
+ * @param scale The scale factor.
+ */
+VECTOR_INLINE void vec3_scale_by(Vector3 *a, double scale){
+    a->x *= scale;
+    a->y *= scale;
+    a->z *= scale;
+}
+
+/**
+ * Element-wise multiply-add, a * b + c.
+ *
+ * @param a The first factor.
+ * @param b The second factor.
+ * @param c The vector added to the product.
+ * @return The element-wise a * b + c.
+ */
+VECTOR_INLINE Vector3 vec3_madd(Vector3 a, Vector3 b, Vector3 c){
+    Vector3 result;
+    result.x = a.x * b.x + c.x;
+    result.y = a.y * b.y + c.y;
+    result.z = a.z * b.z + c.z;
+    return result;
+}
+
+/**
+ * Scale-and-add, a + scale * b, e.g. position + dt * velocity.
+ *
+ * @param a The base vector.
+ * @param scale The factor applied to b.
+ * @param b The vector to scale and add.
+ * @return a + scale * b.
+ */
+VECTOR_INLINE Vector3 vec3_scale_add(Vector3 a, double scale, Vector3 b){
+    Vector3 result;
+    result.x = a.x + scale * b.x;
+    result.y = a.y + scale * b.y;
+    result.z = a.z + scale * b.z;
+    return result;
+}
+
+/**
+ * In-place scale-and-add (a += scale * b).
+ *
+ * @param a Pointer to the vector being accumulated.
+ * @param scale The factor applied to b.
+ * @param b The vector to scale and add.
+ */
+VECTOR_INLINE void vec3_scale_add_to(Vector3 *a, double scale, Vector3 b){
+    a->x += scale * b.x;
+    a->y += scale * b.y;
+    a->z += scale * b.z;
+}
 
 /**
  * @struct Vector2
@@ -130,7 +388,9 @@ void vec2_print(Vector2 v);
  * @param v The 2D vector.
  * @return The magnitude of the vector.
  */
-double vec2_magnitude(Vector2 v);
+VECTOR_INLINE double vec2_magnitude(Vector2 v){
+    return sqrt(v.x * v.x + v.y * v.y);
+}
 
 /**
  * @brief Normalize a 2D vector.
@@ -139,7 +399,11 @@ double vec2_magnitude(Vector2 v);
  *
  * @param v The vector to be normalized.
  */
-void vec2_normalize(Vector2 *v);
+VECTOR_INLINE void vec2_normalize(Vector2 *v){
+    double inv = 1 / vec2_magnitude(*v);
+    v->x *= inv;
+    v->y *= inv;
+}
 
 /**
  * Calculates the normalized vector of a given Vector2.
@@ -147,7 +411,40 @@ void vec2_normalize(Vector2 *v);
  * @param v The Vector2 to be normalized.
  * @return The normalized Vector2.
  */
-Vector2 vec2_normalized(Vector2 v);
+VECTOR_INLINE Vector2 vec2_normalized(Vector2 v){
+    double inv = 1 / vec2_magnitude(v);
+    Vector2 result;
+    result.x = v.x * inv;
+    result.y = v.y * inv;
+    return result;
+}
+
+/**
+ * Normalizes a 2D vector in place using vec_rsqrt_fast.
+ *
+ * The length of the result is within 3e-7 of 1 (5e-6 without SSE).
+ * A zero vector stays zero, with no branch.
+ *
+ * @param v Pointer to the vector to be normalized.
+ */
+VECTOR_INLINE void vec2_normalize_fast(Vector2 *v){
+    double inv = vec_rsqrt_fast(v->x * v->x + v->y * v->y);
+    v->x *= inv;
+    v->y *= inv;
+}
+
+/**
+ * Returns a normalized copy of a 2D vector using vec_rsqrt_fast.
+ *
+ * Same accuracy and zero handling as vec2_normalize_fast.
+ *
+ * @param v The vector to be normalized.
+ * @return The approximately unit-length vector, or zero for a zero vector.
+ */
+VECTOR_INLINE Vector2 vec2_normalized_fast(Vector2 v){
+    vec2_normalize_fast(&v);
+    return v;
+}
 
 /**
  * Adds two 2D vectors.
@@ -156,7 +453,12 @@ Vector2 vec2_normalized(Vector2 v);
  * @param b The second vector.
  * @return The sum of the two vectors.
  */
-Vector2 vec2_add(Vector2 a, Vector2 b);
+VECTOR_INLINE Vector2 vec2_add(Vector2 a, Vector2 b){
+    Vector2 result;
+    result.x = a.x + b.x;
+    result.y = a.y + b.y;
+    return result;
+}
 
 /**
  * Subtracts two 2D vectors.
@@ -165,7 +467,12 @@ Vector2 vec2_add(Vector2 a, Vector2 b);
  * @param b The second vector.
  * @return The result of subtracting vector b from vector a.
  */
-Vector2 vec2_sub(Vector2 a, Vector2 b);
+VECTOR_INLINE Vector2 vec2_sub(Vector2 a, Vector2 b){
+    Vector2 result;
+    result.x = a.x - b.x;
+    result.y = a.y - b.y;
+    return result;
+}
 
 /**
  * Multiplies two 2D vectors element-wise.
@@ -174,7 +481,12 @@ Vector2 vec2_sub(Vector2 a, Vector2 b);
  * @param b The second vector.
  * @return The resulting vector after element-wise multiplication.
  */
-Vector2 vec2_mult(Vector2 a, Vector2 b);
+VECTOR_INLINE Vector2 vec2_mult(Vector2 a, Vector2 b){
+    Vector2 result;
+    result.x = a.x * b.x;
+    result.y = a.y * b.y;
+    return result;
+}
 /**
  * Divides two 2D vectors.
  *
@@ -182,7 +494,12 @@ Vector2 vec2_mult(Vector2 a, Vector2 b);
  * @param b The second vector.
  * @return The result of dividing vector a by vector b.
  */
-Vector2 vec2_div(Vector2 a, Vector2 b);
+VECTOR_INLINE Vector2 vec2_div(Vector2 a, Vector2 b){
+    Vector2 result;
+    result.x = a.x / b.x;
+    result.y = a.y / b.y;
+    return result;
+}
 
 /**
  * @brief Scales a 2D vector by a given scale factor.
@@ -192,7 +509,562 @@ Vector2 vec2_div(Vector2 a, Vector2 b);
  * @param scale The scale factor to multiply the vector by.
  * @return The scaled vector.
  */
-Vector2 vec2_scale(Vector2 v, double scale);
+VECTOR_INLINE Vector2 vec2_scale(Vector2 v, double scale){
+    Vector2 result;
+    result.x = v.x * scale;
+    result.y = v.y * scale;
+    return result;
+}
+
+/**
+ * Calculates the dot product of two 2D vectors.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @return a . b
+ */
+VECTOR_INLINE double vec2_dot(Vector2 a, Vector2 b){
+    return a.x * b.x + a.y * b.y;
+}
+
+/**
+ * Linearly interpolates between two 2D vectors.
+ *
+ * @param a The vector at t = 0.
+ * @param b The vector at t = 1.
+ * @param t The interpolation parameter.
+ * @return a + t * (b - a)
+ */
+VECTOR_INLINE Vector2 vec2_lerp(Vector2 a, Vector2 b, double t){
+    Vector2 result;
+    result.x = a.x + t * (b.x - a.x);
+    result.y = a.y + t * (b.y - a.y);
+    return result;
+}
+
+/**
+ * Reflects a 2D vector about a line with the given normal.
+ *
+ * @param v The incoming vector.
+ * @param n The unit normal of the line.
+ * @return v - 2 (v . n) n
+ */
+VECTOR_INLINE Vector2 vec2_reflect(Vector2 v, Vector2 n){
+    double d = 2 * (v.x * n.x + v.y * n.y);
+    Vector2 result;
+    result.x = v.x - d * n.x;
+    result.y = v.y - d * n.y;
+    return result;
+}
+
+/**
+ * Calculates the distance between two 2D points.
+ *
+ * @param a The first point.
+ * @param b The second point.
+ * @return |a - b|
+ */
+VECTOR_INLINE double vec2_distance(Vector2 a, Vector2 b){
+    double dx = a.x - b.x, dy = a.y - b.y;
+    return sqrt(dx * dx + dy * dy);
+}
+
+/**
+ * Adds b to a in place (a += b).
+ *
+ * @param a Pointer to the vector being accumulated.
+ * @param b The vector to add.
+ */
+VECTOR_INLINE void vec2_add_to(Vector2 *a, Vector2 b){
+    a->x += b.x;
+    a->y += b.y;
+}
+
+/**
+ * Subtracts b from a in place (a -= b).
+ *
+ * @param a Pointer to the vector being accumulated.
+ * @param b The vector to subtract.
+ */
+VECTOR_INLINE void vec2_sub_from(Vector2 *a, Vector2 b){
+    a->x -= b.x;
+    a->y -= b.y;
+}
+
+/**
+ * Scales a vector in place (a *= scale).
+ *
+ * @param a Pointer to the vector to scale.
+ * @param scale The scale factor.
+ */
+VECTOR_INLINE void vec2_scale_by(Vector2 *a, double scale){
+    a->x *= scale;
+    a->y *= scale;
+}
+
+/**
+ * Element-wise multiply-add, a * b + c.
+ *
+ * @param a The first factor.
+ * @param b The second factor.
+ * @param c The vector added to the product.
+ * @return The element-wise a * b + c.
+ */
+VECTOR_INLINE Vector2 vec2_madd(Vector2 a, Vector2 b, Vector2 c){
+    Vector2 result;
+    result.x = a.x * b.x + c.x;
+    result.y = a.y * b.y + c.y;
+    return result;
+}
+
+/**
+ * Scale-and-add, a + scale * b, e.g. position + dt * velocity.
+ *
+ * @param a The base vector.
+ * @param scale The factor applied to b.
+ * @param b The vector to scale and add.
+ * @return a + scale * b.
+ */
+VECTOR_INLINE Vector2 vec2_scale_add(Vector2 a, double scale, Vector2 b){
+    Vector2 result;
+    result.x = a.x + scale * b.x;
+    result.y = a.y + scale * b.y;
+    return result;
+}
+
+/**
+ * In-place scale-and-add (a += scale * b).
+ *
+ * @param a Pointer to the vector being accumulated.
+ * @param scale The factor applied to b.
+ * @param b The vector to scale and add.
+ */
+VECTOR_INLINE void vec2_scale_add_to(Vector2 *a, double scale, Vector2 b){
+    a->x += scale * b.x;
+    a->y += scale * b.y;
+}
+
+
+/*
+ * Batch forms.
+ *
+ * Each applies the matching Vector3 operation to n elements of plain Vector3
+ * arrays, out[i] = op(a[i], b[i]).  out may be the same array as an input.
+ * For data that is stored component-wise see Vector3Array in vector_array.h.
+ */
+
+/**
+ * out[i] = vec3_add(a[i], b[i]) for i in [0, n).
+ */
+void vec3_add_batch(Vector3 out[], const Vector3 a[], const Vector3 b[], int n);
+
+/**
+ * out[i] = vec3_sub(a[i], b[i]) for i in [0, n).
+ */
+void vec3_sub_batch(Vector3 out[], const Vector3 a[], const Vector3 b[], int n);
+
+/**
+ * out[i] = vec3_mult(a[i], b[i]) for i in [0, n).
+ */
+void vec3_mult_batch(Vector3 out[], const Vector3 a[], const Vector3 b[], int n);
+
+/**
+ * out[i] = vec3_div(a[i], b[i]) for i in [0, n).
+ */
+void vec3_div_batch(Vector3 out[], const Vector3 a[], const Vector3 b[], int n);
+
+/**
+ * out[i] = vec3_scale(a[i], scale) for i in [0, n).
+ */
+void vec3_scale_batch(Vector3 out[], const Vector3 a[], double scale, int n);
+
+/**
+ * out[i] = vec3_cross_prod(a[i], b[i]) for i in [0, n).
+ */
+void vec3_cross_prod_batch(Vector3 out[], const Vector3 a[], const Vector3 b[], int n);
+
+/**
+ * out[i] = vec3_dot(a[i], b[i]) for i in [0, n).
+ */
+void vec3_dot_batch(double out[], const Vector3 a[], const Vector3 b[], int n);
+
+/**
+ * out[i] = vec3_magnitude(a[i]) for i in [0, n).
+ */
+void vec3_magnitude_batch(double out[], const Vector3 a[], int n);
+
+/**
+ * out[i] = vec3_normalized(a[i]) for i in [0, n).
+ */
+void vec3_normalized_batch(Vector3 out[], const Vector3 a[], int n);
+
+/**
+ * out[i] = vec3_normalized_fast(a[i]) for i in [0, n).
+ */
+void vec3_normalized_fast_batch(Vector3 out[], const Vector3 a[], int n);
+
+/**
+ * out[i] = vec3_lerp(a[i], b[i], t) for i in [0, n).
+ */
+void vec3_lerp_batch(Vector3 out[], const Vector3 a[], const Vector3 b[], double t, int n);
+
+/**
+ * out[i] = vec3_reflect(v[i], normal[i]) for i in [0, n).
+ */
+void vec3_reflect_batch(Vector3 out[], const Vector3 v[], const Vector3 normal[], int n);
+
+/**
+ * out[i] = vec3_distance(a[i], b[i]) for i in [0, n).
+ */
+void vec3_distance_batch(double out[], const Vector3 a[], const Vector3 b[], int n);
+
+/*
+ * Single precision variants.
+ *
+ * Vector3f and Vector2f mirror Vector3 and Vector2 with float components, for hot
+ * per-vertex and per-pixel data that does not need double's mantissa.  The
+ * conversion helpers let data live in float while sums are accumulated in double.
+ */
+
+/**
+ * @struct Vector3f
+ * @brief Single precision Vector3.
+ */
+typedef struct Vector3f {
+    float x;
+    float y;
+    float z;
+} Vector3f;
+
+/**
+ * @struct Vector2f
+ * @brief Single precision Vector2.
+ */
+typedef struct Vector2f {
+    float x;
+    float y;
+} Vector2f;
+
+/**
+ * Converts a Vector3 to single precision.
+ *
+ * @param v The double precision vector.
+ * @return The vector rounded to float.
+ */
+VECTOR_INLINE Vector3f vec3f_from_vec3(Vector3 v){
+    Vector3f result;
+    result.x = (float)v.x;
+    result.y = (float)v.y;
+    result.z = (float)v.z;
+    return result;
+}
+
+/**
+ * Converts a Vector3f to double precision.
+ *
+ * @param v The single precision vector.
+ * @return The vector widened to double.
+ */
+VECTOR_INLINE Vector3 vec3_from_vec3f(Vector3f v){
+    Vector3 result;
+    result.x = v.x;
+    result.y = v.y;
+    result.z = v.z;
+    return result;
+}
+
+/**
+ * Converts an array of Vector3 to single precision.
+ *
+ * @param out The Vector3f array.
+ * @param v The Vector3 array.
+ * @param n The number of vectors.
+ */
+VECTOR_INLINE void vec3f_from_vec3_array(Vector3f out[], const Vector3 v[], int n){
+    int i;
+    for (i = 0; i < n; i++){
+        out[i] = vec3f_from_vec3(v[i]);
+    }
+}
+
+/**
+ * Converts an array of Vector3f to double precision.
+ *
+ * @param out The Vector3 array.
+ * @param v The Vector3f array.
+ * @param n The number of vectors.
+ */
+VECTOR_INLINE void vec3_from_vec3f_array(Vector3 out[], const Vector3f v[], int n){
+    int i;
+    for (i = 0; i < n; i++){
+        out[i] = vec3_from_vec3f(v[i]);
+    }
+}
+
+/**
+ * Converts a Vector2 to single precision.
+ *
+ * @param v The double precision vector.
+ * @return The vector rounded to float.
+ */
+VECTOR_INLINE Vector2f vec2f_from_vec2(Vector2 v){
+    Vector2f result;
+    result.x = (float)v.x;
+    result.y = (float)v.y;
+    return result;
+}
+
+/**
+ * Converts a Vector2f to double precision.
+ *
+ * @param v The single precision vector.
+ * @return The vector widened to double.
+ */
+VECTOR_INLINE Vector2 vec2_from_vec2f(Vector2f v){
+    Vector2 result;
+    result.x = v.x;
+    result.y = v.y;
+    return result;
+}
+
+/**
+ * Prints the components of a Vector3f.
+ *
+ * @param v The Vector3f to be printed.
+ */
+void vec3f_print(Vector3f v);
+
+/**
+ * Calculates the magnitude of a Vector3f.
+ *
+ * @param v The vector.
+ * @return The magnitude of the vector.
+ */
+VECTOR_INLINE float vec3f_magnitude(Vector3f v){
+    return sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+}
+
+/**
+ * Normalizes a Vector3f in place.
+ *
+ * @param v Pointer to the vector to be normalized.
+ */
+VECTOR_INLINE void vec3f_normalize(Vector3f *v){
+    float inv = 1 / vec3f_magnitude(*v);
+    v->x *= inv;
+    v->y *= inv;
+    v->z *= inv;
+}
+
+/**
+ * Returns a normalized copy of a Vector3f.
+ *
+ * @param v The vector to be normalized.
+ * @return The normalized vector.
+ */
+VECTOR_INLINE Vector3f vec3f_normalized(Vector3f v){
+    vec3f_normalize(&v);
+    return v;
+}
+
+/**
+ * Adds two Vector3f.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @return a + b.
+ */
+VECTOR_INLINE Vector3f vec3f_add(Vector3f a, Vector3f b){
+    Vector3f result;
+    result.x = a.x + b.x;
+    result.y = a.y + b.y;
+    result.z = a.z + b.z;
+    return result;
+}
+
+/**
+ * Subtracts two Vector3f.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @return a - b.
+ */
+VECTOR_INLINE Vector3f vec3f_sub(Vector3f a, Vector3f b){
+    Vector3f result;
+    result.x = a.x - b.x;
+    result.y = a.y - b.y;
+    result.z = a.z - b.z;
+    return result;
+}
+
+/**
+ * Multiplies two Vector3f element-wise.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @return The element-wise product.
+ */
+VECTOR_INLINE Vector3f vec3f_mult(Vector3f a, Vector3f b){
+    Vector3f result;
+    result.x = a.x * b.x;
+    result.y = a.y * b.y;
+    result.z = a.z * b.z;
+    return result;
+}
+
+/**
+ * Divides two Vector3f element-wise.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @return The element-wise quotient.
+ */
+VECTOR_INLINE Vector3f vec3f_div(Vector3f a, Vector3f b){
+    Vector3f result;
+    result.x = a.x / b.x;
+    result.y = a.y / b.y;
+    result.z = a.z / b.z;
+    return result;
+}
+
+/**
+ * Scales a Vector3f by a given scale factor.
+ *
+ * @param v The vector.
+ * @param scale The scale factor.
+ * @return The scaled vector.
+ */
+VECTOR_INLINE Vector3f vec3f_scale(Vector3f v, float scale){
+    Vector3f result;
+    result.x = v.x * scale;
+    result.y = v.y * scale;
+    result.z = v.z * scale;
+    return result;
+}
+
+/**
+ * Calculates the cross product of two Vector3f.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @return a x b.
+ */
+VECTOR_INLINE Vector3f vec3f_cross_prod(Vector3f a, Vector3f b){
+    Vector3f result;
+    result.x = (a.y * b.z) - (b.y * a.z);
+    result.y = (b.x * a.z) - (a.x * b.z);
+    result.z = (a.x * b.y) - (b.x * a.y);
+    return result;
+}
+
+/**
+ * Prints the components of a Vector2f.
+ *
+ * @param v The Vector2f to be printed.
+ */
+void vec2f_print(Vector2f v);
+
+/**
+ * Calculates the magnitude of a Vector2f.
+ *
+ * @param v The vector.
+ * @return The magnitude of the vector.
+ */
+VECTOR_INLINE float vec2f_magnitude(Vector2f v){
+    return sqrtf(v.x * v.x + v.y * v.y);
+}
+
+/**
+ * Normalizes a Vector2f in place.
+ *
+ * @param v Pointer to the vector to be normalized.
+ */
+VECTOR_INLINE void vec2f_normalize(Vector2f *v){
+    float inv = 1 / vec2f_magnitude(*v);
+    v->x *= inv;
+    v->y *= inv;
+}
+
+/**
+ * Returns a normalized copy of a Vector2f.
+ *
+ * @param v The vector to be normalized.
+ * @return The normalized vector.
+ */
+VECTOR_INLINE Vector2f vec2f_normalized(Vector2f v){
+    vec2f_normalize(&v);
+    return v;
+}
+
+/**
+ * Adds two Vector2f.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @return a + b.
+ */
+VECTOR_INLINE Vector2f vec2f_add(Vector2f a, Vector2f b){
+    Vector2f result;
+    result.x = a.x + b.x;
+    result.y = a.y + b.y;
+    return result;
+}
+
+/**
+ * Subtracts two Vector2f.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @return a - b.
+ */
+VECTOR_INLINE Vector2f vec2f_sub(Vector2f a, Vector2f b){
+    Vector2f result;
+    result.x = a.x - b.x;
+    result.y = a.y - b.y;
+    return result;
+}
+
+/**
+ * Multiplies two Vector2f element-wise.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @return The element-wise product.
+ */
+VECTOR_INLINE Vector2f vec2f_mult(Vector2f a, Vector2f b){
+    Vector2f result;
+    result.x = a.x * b.x;
+    result.y = a.y * b.y;
+    return result;
+}
+
+/**
+ * Divides two Vector2f element-wise.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @return The element-wise quotient.
+ */
+VECTOR_INLINE Vector2f vec2f_div(Vector2f a, Vector2f b){
+    Vector2f result;
+    result.x = a.x / b.x;
+    result.y = a.y / b.y;
+    return result;
+}
+
+/**
+ * Scales a Vector2f by a given scale factor.
+ *
+ * @param v The vector.
+ * @param scale The scale factor.
+ * @return The scaled vector.
+ */
+VECTOR_INLINE Vector2f vec2f_scale(Vector2f v, float scale){
+    Vector2f result;
+    result.x = v.x * scale;
+    result.y = v.y * scale;
+    return result;
+}
 
 
 #endif
\ No newline at end of file
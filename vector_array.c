@@ -0,0 +1,611 @@
+#define VECTOR_ARRAY_INLINE extern inline
+#define _POSIX_C_SOURCE 200112L // posix_memalign
+
+#include "vector_array.h"
+#include <math.h>
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+
+/*
+ * A thin layer over the widest double-precision SIMD the compiler was told about.
+ * VA_WIDTH doubles are processed per step; the leftovers run through the scalar
+ * code that follows each loop.  All Vector3Array bases are 32-byte aligned, so the
+ * aligned loads and stores are safe at every multiple of VA_WIDTH; plain double[]
+ * outputs supplied by the caller are written with unaligned stores.
+ */
+#if defined(__AVX__)
+
+#define VA_WIDTH 4
+typedef __m256d va_double;
+#define VA_LOAD(p)      _mm256_load_pd(p)
+#define VA_STORE(p, v)  _mm256_store_pd(p, v)
+#define VA_STOREU(p, v) _mm256_storeu_pd(p, v)
+#define VA_SET1(d)      _mm256_set1_pd(d)
+#define VA_ADD(a, b)    _mm256_add_pd(a, b)
+#define VA_SUB(a, b)    _mm256_sub_pd(a, b)
+#define VA_MUL(a, b)    _mm256_mul_pd(a, b)
+#define VA_DIV(a, b)    _mm256_div_pd(a, b)
+#define VA_SQRT(a)      _mm256_sqrt_pd(a)
+// single precision estimate of 1/sqrt(a), clamped so that a = 0 stays finite
+#define VA_RSQRT_EST(a) _mm256_cvtps_pd(_mm_rsqrt_ps(_mm_max_ps(_mm256_cvtpd_ps(a), _mm_set1_ps(FLT_MIN))))
+
+#elif defined(__SSE2__)
+
+#define VA_WIDTH 2
+typedef __m128d va_double;
+#define VA_LOAD(p)      _mm_load_pd(p)
+#define VA_STORE(p, v)  _mm_store_pd(p, v)
+#define VA_STOREU(p, v) _mm_storeu_pd(p, v)
+#define VA_SET1(d)      _mm_set1_pd(d)
+#define VA_ADD(a, b)    _mm_add_pd(a, b)
+#define VA_SUB(a, b)    _mm_sub_pd(a, b)
+#define VA_MUL(a, b)    _mm_mul_pd(a, b)
+#define VA_DIV(a, b)    _mm_div_pd(a, b)
+#define VA_SQRT(a)      _mm_sqrt_pd(a)
+#define VA_RSQRT_EST(a) _mm_cvtps_pd(_mm_rsqrt_ps(_mm_max_ps(_mm_cvtpd_ps(a), _mm_set1_ps(FLT_MIN))))
+
+#else
+
+#define VA_WIDTH 1
+
+#endif
+
+#define VA_ALIGN 32
+
+
+/*
+ * Transposes between VA_WIDTH packed Vector3 structs (x0 y0 z0 x1 y1 z1 ...) and one
+ * register per component, using only shuffles so the data never leaves registers.
+ */
+#if defined(__AVX__)
+
+static inline void va_aos_load(const double *p, va_double *x, va_double *y, va_double *z){
+    __m256d r0 = _mm256_loadu_pd(p);        // x0 y0 z0 x1
+    __m256d r1 = _mm256_loadu_pd(p + 4);    // y1 z1 x2 y2
+    __m256d r2 = _mm256_loadu_pd(p + 8);    // z2 x3 y3 z3
+    __m256d u0 = _mm256_permute2f128_pd(r0, r1, 0x30);  // x0 y0 x2 y2
+    __m256d u1 = _mm256_permute2f128_pd(r0, r2, 0x21);  // z0 x1 z2 x3
+    __m256d u2 = _mm256_permute2f128_pd(r1, r2, 0x30);  // y1 z1 y3 z3
+    *x = _mm256_shuffle_pd(u0, u1, 0xA);
+    *y = _mm256_shuffle_pd(u0, u2, 0x5);
+    *z = _mm256_shuffle_pd(u1, u2, 0xA);
+}
+
+static inline void va_aos_store(double *p, va_double x, va_double y, va_double z){
+    __m256d u0 = _mm256_shuffle_pd(x, y, 0x0);  // x0 y0 x2 y2
+    __m256d u1 = _mm256_shuffle_pd(z, x, 0xA);  // z0 x1 z2 x3
+    __m256d u2 = _mm256_shuffle_pd(y, z, 0xF);  // y1 z1 y3 z3
+    _mm256_storeu_pd(p,     _mm256_permute2f128_pd(u0, u1, 0x20));
+    _mm256_storeu_pd(p + 4, _mm256_permute2f128_pd(u2, u0, 0x30));
+    _mm256_storeu_pd(p + 8, _mm256_permute2f128_pd(u1, u2, 0x31));
+}
+
+#elif defined(__SSE2__)
+
+static inline void va_aos_load(const double *p, va_double *x, va_double *y, va_double *z){
+    __m128d r0 = _mm_loadu_pd(p);       // x0 y0
+    __m128d r1 = _mm_loadu_pd(p + 2);   // z0 x1
+    __m128d r2 = _mm_loadu_pd(p + 4);   // y1 z1
+    *x = _mm_shuffle_pd(r0, r1, 0x2);
+    *y = _mm_shuffle_pd(r0, r2, 0x1);
+    *z = _mm_shuffle_pd(r1, r2, 0x2);
+}
+
+static inline void va_aos_store(double *p, va_double x, va_double y, va_double z){
+    _mm_storeu_pd(p,     _mm_shuffle_pd(x, y, 0x0));
+    _mm_storeu_pd(p + 2, _mm_shuffle_pd(z, x, 0x2));
+    _mm_storeu_pd(p + 4, _mm_shuffle_pd(y, z, 0x3));
+}
+
+#endif
+
+
+/* Storage */
+
+static double *alloc_component(int capacity){
+    void *p;
+    if (posix_memalign(&p, VA_ALIGN, (size_t)capacity * sizeof(double)) != 0){
+        return NULL;
+    }
+    return (double *)p;
+}
+
+int vec3_array_init(Vector3Array *a, int capacity){
+    a->x = NULL;
+    a->y = NULL;
+    a->z = NULL;
+    a->count = 0;
+    a->capacity = 0;
+    return vec3_array_reserve(a, capacity);
+}
+
+void vec3_array_free(Vector3Array *a){
+    free(a->x);
+    free(a->y);
+    free(a->z);
+    a->x = NULL;
+    a->y = NULL;
+    a->z = NULL;
+    a->count = 0;
+    a->capacity = 0;
+}
+
+int vec3_array_reserve(Vector3Array *a, int capacity){
+    double *x, *y, *z;
+
+    if (capacity < 4){
+        capacity = 4;
+    }
+    if (capacity <= a->capacity){
+        return 1;
+    }
+
+    x = alloc_component(capacity);
+    y = alloc_component(capacity);
+    z = alloc_component(capacity);
+    if (x == NULL || y == NULL || z == NULL){
+        free(x);
+        free(y);
+        free(z);
+        return 0;
+    }
+
+    if (a->count > 0){
+        memcpy(x, a->x, a->count * sizeof(double));
+        memcpy(y, a->y, a->count * sizeof(double));
+        memcpy(z, a->z, a->count * sizeof(double));
+    }
+    free(a->x);
+    free(a->y);
+    free(a->z);
+
+    a->x = x;
+    a->y = y;
+    a->z = z;
+    a->capacity = capacity;
+    return 1;
+}
+
+int vec3_array_push(Vector3Array *a, Vector3 v){
+    if (a->count == a->capacity && !vec3_array_reserve(a, 2 * a->capacity)){
+        return 0;
+    }
+    vec3_array_set(a, a->count, v);
+    a->count++;
+    return 1;
+}
+
+
+/* Batch kernels */
+
+// the same loop shape for the four component-wise operations
+#define VA_COMPONENTWISE(out, a, b, VOP, op)                               \
+    int i = 0, n = (a)->count;                                             \
+    if ((out)->capacity < n) return 0;                                     \
+    VA_SIMD_LOOP(                                                          \
+        VA_STORE((out)->x + i, VOP(VA_LOAD((a)->x + i), VA_LOAD((b)->x + i))); \
+        VA_STORE((out)->y + i, VOP(VA_LOAD((a)->y + i), VA_LOAD((b)->y + i))); \
+        VA_STORE((out)->z + i, VOP(VA_LOAD((a)->z + i), VA_LOAD((b)->z + i))); \
+    )                                                                      \
+    for (; i < n; i++){                                                    \
+        (out)->x[i] = (a)->x[i] op (b)->x[i];                              \
+        (out)->y[i] = (a)->y[i] op (b)->y[i];                              \
+        (out)->z[i] = (a)->z[i] op (b)->z[i];                              \
+    }                                                                      \
+    (out)->count = n;                                                      \
+    return 1;
+
+#if VA_WIDTH > 1
+#define VA_SIMD_LOOP(body) for (; i + VA_WIDTH <= n; i += VA_WIDTH){ body }
+#else
+#define VA_SIMD_LOOP(body)
+#endif
+
+int vec3_array_add(Vector3Array *out, const Vector3Array *a, const Vector3Array *b){
+    VA_COMPONENTWISE(out, a, b, VA_ADD, +)
+}
+
+int vec3_array_sub(Vector3Array *out, const Vector3Array *a, const Vector3Array *b){
+    VA_COMPONENTWISE(out, a, b, VA_SUB, -)
+}
+
+int vec3_array_mult(Vector3Array *out, const Vector3Array *a, const Vector3Array *b){
+    VA_COMPONENTWISE(out, a, b, VA_MUL, *)
+}
+
+int vec3_array_div(Vector3Array *out, const Vector3Array *a, const Vector3Array *b){
+    VA_COMPONENTWISE(out, a, b, VA_DIV, /)
+}
+
+int vec3_array_scale(Vector3Array *out, const Vector3Array *a, double scale){
+    int i = 0, n = a->count;
+    if (out->capacity < n) return 0;
+#if VA_WIDTH > 1
+    va_double s = VA_SET1(scale);
+    for (; i + VA_WIDTH <= n; i += VA_WIDTH){
+        VA_STORE(out->x + i, VA_MUL(VA_LOAD(a->x + i), s));
+        VA_STORE(out->y + i, VA_MUL(VA_LOAD(a->y + i), s));
+        VA_STORE(out->z + i, VA_MUL(VA_LOAD(a->z + i), s));
+    }
+#endif
+    for (; i < n; i++){
+        out->x[i] = a->x[i] * scale;
+        out->y[i] = a->y[i] * scale;
+        out->z[i] = a->z[i] * scale;
+    }
+    out->count = n;
+    return 1;
+}
+
+int vec3_array_dot(double out[], const Vector3Array *a, const Vector3Array *b){
+    int i = 0, n = a->count;
+#if VA_WIDTH > 1
+    for (; i + VA_WIDTH <= n; i += VA_WIDTH){
+        va_double d = VA_MUL(VA_LOAD(a->x + i), VA_LOAD(b->x + i));
+        d = VA_ADD(d, VA_MUL(VA_LOAD(a->y + i), VA_LOAD(b->y + i)));
+        d = VA_ADD(d, VA_MUL(VA_LOAD(a->z + i), VA_LOAD(b->z + i)));
+        VA_STOREU(out + i, d);
+    }
+#endif
+    for (; i < n; i++){
+        out[i] = a->x[i] * b->x[i] + a->y[i] * b->y[i] + a->z[i] * b->z[i];
+    }
+    return 1;
+}
+
+int vec3_array_cross(Vector3Array *out, const Vector3Array *a, const Vector3Array *b){
+    int i = 0, n = a->count;
+    double cx, cy, cz;
+    if (out->capacity < n) return 0;
+#if VA_WIDTH > 1
+    for (; i + VA_WIDTH <= n; i += VA_WIDTH){
+        va_double ax = VA_LOAD(a->x + i), ay = VA_LOAD(a->y + i), az = VA_LOAD(a->z + i);
+        va_double bx = VA_LOAD(b->x + i), by = VA_LOAD(b->y + i), bz = VA_LOAD(b->z + i);
+        VA_STORE(out->x + i, VA_SUB(VA_MUL(ay, bz), VA_MUL(az, by)));
+        VA_STORE(out->y + i, VA_SUB(VA_MUL(az, bx), VA_MUL(ax, bz)));
+        VA_STORE(out->z + i, VA_SUB(VA_MUL(ax, by), VA_MUL(ay, bx)));
+    }
+#endif
+    for (; i < n; i++){
+        cx = a->y[i] * b->z[i] - a->z[i] * b->y[i];
+        cy = a->z[i] * b->x[i] - a->x[i] * b->z[i];
+        cz = a->x[i] * b->y[i] - a->y[i] * b->x[i];
+        out->x[i] = cx;
+        out->y[i] = cy;
+        out->z[i] = cz;
+    }
+    out->count = n;
+    return 1;
+}
+
+int vec3_array_lerp(Vector3Array *out, const Vector3Array *a, const Vector3Array *b, double t){
+    int i = 0, n = a->count;
+    if (out->capacity < n) return 0;
+#if VA_WIDTH > 1
+    va_double vt = VA_SET1(t);
+    for (; i + VA_WIDTH <= n; i += VA_WIDTH){
+        va_double ax = VA_LOAD(a->x + i), ay = VA_LOAD(a->y + i), az = VA_LOAD(a->z + i);
+        VA_STORE(out->x + i, VA_ADD(ax, VA_MUL(vt, VA_SUB(VA_LOAD(b->x + i), ax))));
+        VA_STORE(out->y + i, VA_ADD(ay, VA_MUL(vt, VA_SUB(VA_LOAD(b->y + i), ay))));
+        VA_STORE(out->z + i, VA_ADD(az, VA_MUL(vt, VA_SUB(VA_LOAD(b->z + i), az))));
+    }
+#endif
+    for (; i < n; i++){
+        out->x[i] = a->x[i] + t * (b->x[i] - a->x[i]);
+        out->y[i] = a->y[i] + t * (b->y[i] - a->y[i]);
+        out->z[i] = a->z[i] + t * (b->z[i] - a->z[i]);
+    }
+    out->count = n;
+    return 1;
+}
+
+int vec3_array_reflect(Vector3Array *out, const Vector3Array *v, const Vector3Array *normal){
+    int i = 0, n = v->count;
+    double d;
+    if (out->capacity < n) return 0;
+#if VA_WIDTH > 1
+    va_double two = VA_SET1(2.0);
+    for (; i + VA_WIDTH <= n; i += VA_WIDTH){
+        va_double x = VA_LOAD(v->x + i), y = VA_LOAD(v->y + i), z = VA_LOAD(v->z + i);
+        va_double nx = VA_LOAD(normal->x + i), ny = VA_LOAD(normal->y + i), nz = VA_LOAD(normal->z + i);
+        va_double dd = VA_ADD(VA_ADD(VA_MUL(x, nx), VA_MUL(y, ny)), VA_MUL(z, nz));
+        dd = VA_MUL(two, dd);
+        VA_STORE(out->x + i, VA_SUB(x, VA_MUL(dd, nx)));
+        VA_STORE(out->y + i, VA_SUB(y, VA_MUL(dd, ny)));
+        VA_STORE(out->z + i, VA_SUB(z, VA_MUL(dd, nz)));
+    }
+#endif
+    for (; i < n; i++){
+        d = 2 * (v->x[i] * normal->x[i] + v->y[i] * normal->y[i] + v->z[i] * normal->z[i]);
+        out->x[i] = v->x[i] - d * normal->x[i];
+        out->y[i] = v->y[i] - d * normal->y[i];
+        out->z[i] = v->z[i] - d * normal->z[i];
+    }
+    out->count = n;
+    return 1;
+}
+
+int vec3_array_distance(double out[], const Vector3Array *a, const Vector3Array *b){
+    int i = 0, n = a->count;
+    double dx, dy, dz;
+#if VA_WIDTH > 1
+    for (; i + VA_WIDTH <= n; i += VA_WIDTH){
+        va_double x = VA_SUB(VA_LOAD(a->x + i), VA_LOAD(b->x + i));
+        va_double y = VA_SUB(VA_LOAD(a->y + i), VA_LOAD(b->y + i));
+        va_double z = VA_SUB(VA_LOAD(a->z + i), VA_LOAD(b->z + i));
+        VA_STOREU(out + i, VA_SQRT(VA_ADD(VA_ADD(VA_MUL(x, x), VA_MUL(y, y)), VA_MUL(z, z))));
+    }
+#endif
+    for (; i < n; i++){
+        dx = a->x[i] - b->x[i];
+        dy = a->y[i] - b->y[i];
+        dz = a->z[i] - b->z[i];
+        out[i] = sqrt(dx * dx + dy * dy + dz * dz);
+    }
+    return 1;
+}
+
+int vec3_array_magnitude(double out[], const Vector3Array *a){
+    int i = 0, n = a->count;
+#if VA_WIDTH > 1
+    for (; i + VA_WIDTH <= n; i += VA_WIDTH){
+        va_double x = VA_LOAD(a->x + i), y = VA_LOAD(a->y + i), z = VA_LOAD(a->z + i);
+        va_double d = VA_ADD(VA_ADD(VA_MUL(x, x), VA_MUL(y, y)), VA_MUL(z, z));
+        VA_STOREU(out + i, VA_SQRT(d));
+    }
+#endif
+    for (; i < n; i++){
+        out[i] = sqrt(a->x[i] * a->x[i] + a->y[i] * a->y[i] + a->z[i] * a->z[i]);
+    }
+    return 1;
+}
+
+int vec3_array_normalize(Vector3Array *out, const Vector3Array *a){
+    int i = 0, n = a->count;
+    double inv;
+    if (out->capacity < n) return 0;
+#if VA_WIDTH > 1
+    va_double one = VA_SET1(1.0);
+    for (; i + VA_WIDTH <= n; i += VA_WIDTH){
+        va_double x = VA_LOAD(a->x + i), y = VA_LOAD(a->y + i), z = VA_LOAD(a->z + i);
+        va_double d = VA_ADD(VA_ADD(VA_MUL(x, x), VA_MUL(y, y)), VA_MUL(z, z));
+        va_double s = VA_DIV(one, VA_SQRT(d));
+        VA_STORE(out->x + i, VA_MUL(x, s));
+        VA_STORE(out->y + i, VA_MUL(y, s));
+        VA_STORE(out->z + i, VA_MUL(z, s));
+    }
+#endif
+    for (; i < n; i++){
+        inv = 1 / sqrt(a->x[i] * a->x[i] + a->y[i] * a->y[i] + a->z[i] * a->z[i]);
+        out->x[i] = a->x[i] * inv;
+        out->y[i] = a->y[i] * inv;
+        out->z[i] = a->z[i] * inv;
+    }
+    out->count = n;
+    return 1;
+}
+
+int vec3_array_normalize_fast(Vector3Array *out, const Vector3Array *a){
+    int i = 0, n = a->count;
+    double inv;
+    if (out->capacity < n) return 0;
+#if VA_WIDTH > 1
+    va_double half = VA_SET1(0.5), three_halves = VA_SET1(1.5);
+    for (; i + VA_WIDTH <= n; i += VA_WIDTH){
+        va_double x = VA_LOAD(a->x + i), y = VA_LOAD(a->y + i), z = VA_LOAD(a->z + i);
+        va_double d = VA_ADD(VA_ADD(VA_MUL(x, x), VA_MUL(y, y)), VA_MUL(z, z));
+        va_double r = VA_RSQRT_EST(d);
+        // one Newton step: r = r * (1.5 - 0.5 * d * r * r)
+        r = VA_MUL(r, VA_SUB(three_halves, VA_MUL(VA_MUL(half, d), VA_MUL(r, r))));
+        VA_STORE(out->x + i, VA_MUL(x, r));
+        VA_STORE(out->y + i, VA_MUL(y, r));
+        VA_STORE(out->z + i, VA_MUL(z, r));
+    }
+#endif
+    for (; i < n; i++){
+        inv = vec_rsqrt_fast(a->x[i] * a->x[i] + a->y[i] * a->y[i] + a->z[i] * a->z[i]);
+        out->x[i] = a->x[i] * inv;
+        out->y[i] = a->y[i] * inv;
+        out->z[i] = a->z[i] * inv;
+    }
+    out->count = n;
+    return 1;
+}
+
+
+/* Bridges to M3d matrices and plain Vector3 arrays */
+
+/*
+ * Inverse-transpose of the upper left 3x3 of m, the matrix that carries normals.
+ * It is the cofactor matrix divided by the determinant.  Returns 0 if m is singular.
+ */
+static int normal_matrix(double nm[3][3], double m[4][4]){
+    double det, inv;
+    int i, j;
+
+    nm[0][0] = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+    nm[0][1] = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+    nm[0][2] = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+    nm[1][0] = m[0][2] * m[2][1] - m[0][1] * m[2][2];
+    nm[1][1] = m[0][0] * m[2][2] - m[0][2] * m[2][0];
+    nm[1][2] = m[0][1] * m[2][0] - m[0][0] * m[2][1];
+    nm[2][0] = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+    nm[2][1] = m[0][2] * m[1][0] - m[0][0] * m[1][2];
+    nm[2][2] = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+
+    det = m[0][0] * nm[0][0] + m[0][1] * nm[0][1] + m[0][2] * nm[0][2];
+    if (det == 0){
+        return 0;
+    }
+    inv = 1 / det;
+    for (i = 0; i < 3; i++){
+        for (j = 0; j < 3; j++){
+            nm[i][j] *= inv;
+        }
+    }
+    return 1;
+}
+
+// r = (rows of a) . (x, y, z) + t, summed left to right as M3d_mat_mult_pt
+// does so that the results are bit-identical; the core of every transform below
+#define VA_XFORM(rx, ry, rz, a, t, x, y, z) \
+    rx = VA_ADD(VA_ADD(VA_ADD(VA_MUL(a[0][0], x), VA_MUL(a[0][1], y)), VA_MUL(a[0][2], z)), t[0]); \
+    ry = VA_ADD(VA_ADD(VA_ADD(VA_MUL(a[1][0], x), VA_MUL(a[1][1], y)), VA_MUL(a[1][2], z)), t[1]); \
+    rz = VA_ADD(VA_ADD(VA_ADD(VA_MUL(a[2][0], x), VA_MUL(a[2][1], y)), VA_MUL(a[2][2], z)), t[2])
+
+// transforms n packed Vector3 by the 3x3 a plus the translation t
+static void transform_aos(Vector3 out[], const Vector3 in[], double a[3][3], const double t[3], int n){
+    int i = 0;
+    double x, y, z;
+#if VA_WIDTH > 1
+    va_double va[3][3], vt[3], vx, vy, vz, rx, ry, rz;
+    int r, c;
+    for (r = 0; r < 3; r++){
+        for (c = 0; c < 3; c++){
+            va[r][c] = VA_SET1(a[r][c]);
+        }
+        vt[r] = VA_SET1(t[r]);
+    }
+    for (; i + VA_WIDTH <= n; i += VA_WIDTH){
+        va_aos_load(&in[i].x, &vx, &vy, &vz);
+        VA_XFORM(rx, ry, rz, va, vt, vx, vy, vz);
+        va_aos_store(&out[i].x, rx, ry, rz);
+    }
+#endif
+    for (; i < n; i++){
+        x = in[i].x;
+        y = in[i].y;
+        z = in[i].z;
+        out[i].x = a[0][0] * x + a[0][1] * y + a[0][2] * z + t[0];
+        out[i].y = a[1][0] * x + a[1][1] * y + a[1][2] * z + t[1];
+        out[i].z = a[2][0] * x + a[2][1] * y + a[2][2] * z + t[2];
+    }
+}
+
+// the same for a Vector3Array
+static void transform_soa(Vector3Array *out, const Vector3Array *in, double a[3][3], const double t[3]){
+    int i = 0, n = in->count;
+    double x, y, z;
+#if VA_WIDTH > 1
+    va_double va[3][3], vt[3], rx, ry, rz;
+    int r, c;
+    for (r = 0; r < 3; r++){
+        for (c = 0; c < 3; c++){
+            va[r][c] = VA_SET1(a[r][c]);
+        }
+        vt[r] = VA_SET1(t[r]);
+    }
+    for (; i + VA_WIDTH <= n; i += VA_WIDTH){
+        va_double vx = VA_LOAD(in->x + i), vy = VA_LOAD(in->y + i), vz = VA_LOAD(in->z + i);
+        VA_XFORM(rx, ry, rz, va, vt, vx, vy, vz);
+        VA_STORE(out->x + i, rx);
+        VA_STORE(out->y + i, ry);
+        VA_STORE(out->z + i, rz);
+    }
+#endif
+    for (; i < n; i++){
+        x = in->x[i];
+        y = in->y[i];
+        z = in->z[i];
+        out->x[i] = a[0][0] * x + a[0][1] * y + a[0][2] * z + t[0];
+        out->y[i] = a[1][0] * x + a[1][1] * y + a[1][2] * z + t[1];
+        out->z[i] = a[2][0] * x + a[2][1] * y + a[2][2] * z + t[2];
+    }
+    out->count = n;
+}
+
+// splits m into its upper left 3x3 and its translation column
+static void split_matrix(double a[3][3], double t[3], double m[4][4]){
+    int r, c;
+    for (r = 0; r < 3; r++){
+        for (c = 0; c < 3; c++){
+            a[r][c] = m[r][c];
+        }
+        t[r] = m[r][3];
+    }
+}
+
+static const double no_translation[3] = {0, 0, 0};
+
+int vec3_transform_points(Vector3 out[], const Vector3 in[], double m[4][4], int n){
+    double a[3][3], t[3];
+    split_matrix(a, t, m);
+    transform_aos(out, in, a, t, n);
+    return 1;
+}
+
+int vec3_transform_directions(Vector3 out[], const Vector3 in[], double m[4][4], int n){
+    double a[3][3], t[3];
+    split_matrix(a, t, m);
+    transform_aos(out, in, a, no_translation, n);
+    return 1;
+}
+
+int vec3_transform_normals(Vector3 out[], const Vector3 in[], double m[4][4], int n){
+    double nm[3][3];
+    if (!normal_matrix(nm, m)) return 0;
+    transform_aos(out, in, nm, no_translation, n);
+    return 1;
+}
+
+int vec3_array_transform_points(Vector3Array *out, const Vector3Array *a, double m[4][4]){
+    double r[3][3], t[3];
+    if (out->capacity < a->count) return 0;
+    split_matrix(r, t, m);
+    transform_soa(out, a, r, t);
+    return 1;
+}
+
+int vec3_array_transform_directions(Vector3Array *out, const Vector3Array *a, double m[4][4]){
+    double r[3][3], t[3];
+    if (out->capacity < a->count) return 0;
+    split_matrix(r, t, m);
+    transform_soa(out, a, r, no_translation);
+    return 1;
+}
+
+int vec3_array_transform_normals(Vector3Array *out, const Vector3Array *a, double m[4][4]){
+    double nm[3][3];
+    if (out->capacity < a->count) return 0;
+    if (!normal_matrix(nm, m)) return 0;
+    transform_soa(out, a, nm, no_translation);
+    return 1;
+}
+
+int vec3_array_from_aos(Vector3Array *out, const Vector3 in[], int n){
+    int i = 0;
+    if (!vec3_array_reserve(out, n)) return 0;
+#if VA_WIDTH > 1
+    for (; i + VA_WIDTH <= n; i += VA_WIDTH){
+        va_double x, y, z;
+        va_aos_load(&in[i].x, &x, &y, &z);
+        VA_STORE(out->x + i, x);
+        VA_STORE(out->y + i, y);
+        VA_STORE(out->z + i, z);
+    }
+#endif
+    for (; i < n; i++){
+        vec3_array_set(out, i, in[i]);
+    }
+    out->count = n;
+    return 1;
+}
+
+int vec3_array_to_aos(Vector3 out[], const Vector3Array *a){
+    int i = 0, n = a->count;
+#if VA_WIDTH > 1
+    for (; i + VA_WIDTH <= n; i += VA_WIDTH){
+        va_aos_store(&out[i].x, VA_LOAD(a->x + i), VA_LOAD(a->y + i), VA_LOAD(a->z + i));
+    }
+#endif
+    for (; i < n; i++){
+        out[i] = vec3_array_get(a, i);
+    }
+    return 1;
+}
@@ -0,0 +1,334 @@
+/**
+ * @file vector_array.h
+ * @brief Structure-of-arrays storage for many 3D vectors, with SIMD batch kernels.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * A Vector3Array keeps the x, y and z components of its vectors in three separate,
+ * 32-byte aligned arrays.  That is the layout M3d_mat_mult_points works on, so an
+ * array can be transformed in place with no copying:
+ *
+ *     M3d_mat_mult_points(a.x, a.y, a.z,  m,  a.x, a.y, a.z,  a.count);
+ *
+ * The batch kernels use AVX when compiled with -mavx (or -march=native on a machine
+ * that has it), SSE2 otherwise on x86-64, and plain loops elsewhere.  Every kernel
+ * works on the first a->count vectors and sets out->count to the same value; the
+ * output may be one of the inputs.  Kernels return 0 without doing anything if an
+ * output array is too small, otherwise 1.
+ */
+
+#ifndef VECTOR_ARRAY_H
+#define VECTOR_ARRAY_H
+
+#include "vector.h"
+
+// same scheme as VECTOR_INLINE in vector.h; vector_array.c emits the external copies
+#ifndef VECTOR_ARRAY_INLINE
+#define VECTOR_ARRAY_INLINE inline
+#endif
+
+/**
+ * @struct Vector3Array
+ * @brief Many Vector3 values stored as separate x, y and z arrays.
+ */
+typedef struct Vector3Array {
+    double *x;
+    double *y;
+    double *z;
+    int count;      // number of vectors in use
+    int capacity;   // number of vectors the arrays can hold
+} Vector3Array;
+
+/**
+ * Allocates an empty array with room for at least capacity vectors.
+ *
+ * @param a The array to initialize.
+ * @param capacity The number of vectors to reserve room for.
+ * @return 1 if successful, 0 if the memory could not be allocated.
+ */
+int vec3_array_init(Vector3Array *a, int capacity);
+
+/**
+ * Frees the storage of an array and leaves it empty.
+ *
+ * @param a The array to free.
+ */
+void vec3_array_free(Vector3Array *a);
+
+/**
+ * Grows an array so that it can hold at least capacity vectors, keeping its contents.
+ *
+ * @param a The array.
+ * @param capacity The number of vectors to make room for.
+ * @return 1 if successful, 0 if the memory could not be allocated.
+ */
+int vec3_array_reserve(Vector3Array *a, int capacity);
+
+/**
+ * Appends a vector, growing the array if needed.
+ *
+ * @param a The array.
+ * @param v The vector to append.
+ * @return 1 if successful, 0 if the memory could not be allocated.
+ */
+int vec3_array_push(Vector3Array *a, Vector3 v);
+
+/**
+ * Returns the i-th vector of an array.
+ *
+ * @param a The array.
+ * @param i The index, in [0, a->count).
+ * @return The vector at index i.
+ */
+VECTOR_ARRAY_INLINE Vector3 vec3_array_get(const Vector3Array *a, int i){
+    Vector3 result;
+    result.x = a->x[i];
+    result.y = a->y[i];
+    result.z = a->z[i];
+    return result;
+}
+
+/**
+ * Stores a vector at index i of an array.
+ *
+ * @param a The array.
+ * @param i The index, in [0, a->capacity).
+ * @param v The vector to store.
+ */
+VECTOR_ARRAY_INLINE void vec3_array_set(Vector3Array *a, int i, Vector3 v){
+    a->x[i] = v.x;
+    a->y[i] = v.y;
+    a->z[i] = v.z;
+}
+
+/**
+ * Adds two arrays element by element, out[i] = a[i] + b[i].
+ *
+ * @param out The result array.
+ * @param a The first array.
+ * @param b The second array, with at least a->count vectors.
+ * @return 1 if successful, 0 if out is too small.
+ */
+int vec3_array_add(Vector3Array *out, const Vector3Array *a, const Vector3Array *b);
+
+/**
+ * Subtracts two arrays element by element, out[i] = a[i] - b[i].
+ *
+ * @param out The result array.
+ * @param a The first array.
+ * @param b The second array, with at least a->count vectors.
+ * @return 1 if successful, 0 if out is too small.
+ */
+int vec3_array_sub(Vector3Array *out, const Vector3Array *a, const Vector3Array *b);
+
+/**
+ * Multiplies two arrays component-wise, out[i] = vec3_mult(a[i], b[i]).
+ *
+ * @param out The result array.
+ * @param a The first array.
+ * @param b The second array, with at least a->count vectors.
+ * @return 1 if successful, 0 if out is too small.
+ */
+int vec3_array_mult(Vector3Array *out, const Vector3Array *a, const Vector3Array *b);
+
+/**
+ * Divides two arrays component-wise, out[i] = vec3_div(a[i], b[i]).
+ *
+ * @param out The result array.
+ * @param a The first array.
+ * @param b The second array, with at least a->count vectors.
+ * @return 1 if successful, 0 if out is too small.
+ */
+int vec3_array_div(Vector3Array *out, const Vector3Array *a, const Vector3Array *b);
+
+/**
+ * Scales every vector of an array, out[i] = scale * a[i].
+ *
+ * @param out The result array.
+ * @param a The array to scale.
+ * @param scale The scale factor.
+ * @return 1 if successful, 0 if out is too small.
+ */
+int vec3_array_scale(Vector3Array *out, const Vector3Array *a, double scale);
+
+/**
+ * Dot products of two arrays, out[i] = a[i] . b[i].
+ *
+ * @param out At least a->count doubles.
+ * @param a The first array.
+ * @param b The second array, with at least a->count vectors.
+ * @return 1 always.
+ */
+int vec3_array_dot(double out[], const Vector3Array *a, const Vector3Array *b);
+
+/**
+ * Cross products of two arrays, out[i] = a[i] x b[i].
+ *
+ * @param out The result array.
+ * @param a The first array.
+ * @param b The second array, with at least a->count vectors.
+ * @return 1 if successful, 0 if out is too small.
+ */
+int vec3_array_cross(Vector3Array *out, const Vector3Array *a, const Vector3Array *b);
+
+/**
+ * Interpolates two arrays element by element, out[i] = vec3_lerp(a[i], b[i], t).
+ *
+ * @param out The result array.
+ * @param a The array at t = 0.
+ * @param b The array at t = 1, with at least a->count vectors.
+ * @param t The interpolation parameter.
+ * @return 1 if successful, 0 if out is too small.
+ */
+int vec3_array_lerp(Vector3Array *out, const Vector3Array *a, const Vector3Array *b, double t);
+
+/**
+ * Reflects every vector about its own unit normal, out[i] = vec3_reflect(v[i], normal[i]).
+ *
+ * @param out The result array.
+ * @param v The vectors to reflect.
+ * @param normal The unit normals, at least v->count of them.
+ * @return 1 if successful, 0 if out is too small.
+ */
+int vec3_array_reflect(Vector3Array *out, const Vector3Array *v, const Vector3Array *normal);
+
+/**
+ * Distances between matching points of two arrays, out[i] = vec3_distance(a[i], b[i]).
+ *
+ * @param out At least a->count doubles.
+ * @param a The first array.
+ * @param b The second array, with at least a->count vectors.
+ * @return 1 always.
+ */
+int vec3_array_distance(double out[], const Vector3Array *a, const Vector3Array *b);
+
+/**
+ * Magnitudes of every vector of an array.
+ *
+ * @param out At least a->count doubles.
+ * @param a The array.
+ * @return 1 always.
+ */
+int vec3_array_magnitude(double out[], const Vector3Array *a);
+
+/**
+ * Normalizes every vector of an array, out[i] = vec3_normalized(a[i]).
+ *
+ * As with vec3_normalized, a zero vector gives NaNs.
+ *
+ * @param out The result array.
+ * @param a The array to normalize.
+ * @return 1 if successful, 0 if out is too small.
+ */
+int vec3_array_normalize(Vector3Array *out, const Vector3Array *a);
+
+/**
+ * Normalizes every vector of an array with the same method as vec3_normalize_fast.
+ *
+ * A SIMD reciprocal square root estimate plus one Newton step per vector: the
+ * lengths of the results are within 3e-7 of 1 (5e-6 with no SSE), and zero
+ * vectors stay zero without any branch.
+ *
+ * @param out The result array.
+ * @param a The array to normalize.
+ * @return 1 if successful, 0 if out is too small.
+ */
+int vec3_array_normalize_fast(Vector3Array *out, const Vector3Array *a);
+
+
+/*
+ * Bridges to M3d matrices and plain Vector3 arrays
+ *
+ * m is a double[4][4] from M3d_matrix_tools.c, applied with the same column-vector
+ * convention as M3d_mat_mult_pt.  The Vector3[] forms transpose each group of
+ * vectors to component registers and back with SIMD shuffles, so they cost about
+ * the same as the Vector3Array forms and need no temporary storage.  out may be in.
+ */
+
+/**
+ * Transforms n points by m, translation included.
+ *
+ * @param out The transformed points.
+ * @param in The points to transform.
+ * @param m The M3d matrix.
+ * @param n The number of points.
+ * @return 1 always.
+ */
+int vec3_transform_points(Vector3 out[], const Vector3 in[], double m[4][4], int n);
+
+/**
+ * Transforms n directions by the upper left 3x3 of m, ignoring its translation.
+ *
+ * @param out The transformed directions.
+ * @param in The directions to transform.
+ * @param m The M3d matrix.
+ * @param n The number of directions.
+ * @return 1 always.
+ */
+int vec3_transform_directions(Vector3 out[], const Vector3 in[], double m[4][4], int n);
+
+/**
+ * Transforms n surface normals by the inverse-transpose of the upper left 3x3 of m.
+ *
+ * This keeps normals perpendicular to their surfaces under non-uniform scaling.
+ * The results are not renormalized.
+ *
+ * @param out The transformed normals.
+ * @param in The normals to transform.
+ * @param m The M3d matrix.
+ * @param n The number of normals.
+ * @return 1 if successful, 0 if m is singular.
+ */
+int vec3_transform_normals(Vector3 out[], const Vector3 in[], double m[4][4], int n);
+
+/**
+ * Transforms every point of an array by m, translation included.
+ *
+ * @param out The result array.
+ * @param a The points to transform.
+ * @param m The M3d matrix.
+ * @return 1 if successful, 0 if out is too small.
+ */
+int vec3_array_transform_points(Vector3Array *out, const Vector3Array *a, double m[4][4]);
+
+/**
+ * Transforms every direction of an array by the upper left 3x3 of m.
+ *
+ * @param out The result array.
+ * @param a The directions to transform.
+ * @param m The M3d matrix.
+ * @return 1 if successful, 0 if out is too small.
+ */
+int vec3_array_transform_directions(Vector3Array *out, const Vector3Array *a, double m[4][4]);
+
+/**
+ * Transforms every normal of an array by the inverse-transpose of the upper left 3x3 of m.
+ *
+ * @param out The result array.
+ * @param a The normals to transform.
+ * @param m The M3d matrix.
+ * @return 1 if successful, 0 if out is too small or m is singular.
+ */
+int vec3_array_transform_normals(Vector3Array *out, const Vector3Array *a, double m[4][4]);
+
+/**
+ * Copies n packed Vector3 values into an array, growing it if needed.
+ *
+ * @param out The array, which ends up with exactly n vectors.
+ * @param in The vectors to copy.
+ * @param n The number of vectors.
+ * @return 1 if successful, 0 if the memory could not be allocated.
+ */
+int vec3_array_from_aos(Vector3Array *out, const Vector3 in[], int n);
+
+/**
+ * Copies the vectors of an array out to packed Vector3 values.
+ *
+ * @param out At least a->count Vector3 values.
+ * @param a The array.
+ * @return 1 always.
+ */
+int vec3_array_to_aos(Vector3 out[], const Vector3Array *a);
+
+
+#endif